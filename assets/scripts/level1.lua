@@ -22,7 +22,18 @@ Level = {
         texture_asset_id = "tilemap-texture",
         num_cols = 10,
         tile_size = 32,
-        scale = 2.0
+        scale = 2.0,
+        -- collision flags by tile index, e.g. [21] = { solid = true, blocks_projectiles = false }
+        -- blocks_projectiles defaults to solid; tiles not listed do not collide
+        tile_properties = {}
+    },
+
+    ----------------------------------------------------
+    -- table to define the collision settings
+    ----------------------------------------------------
+    collision = {
+        broad_phase = "spatial_hash", -- spatial_hash, sweep_and_prune, aabb_tree or brute_force
+        cell_size = 64 -- pixels per broad-phase grid cell
     },
 
     ----------------------------------------------------
@@ -58,7 +69,9 @@ Level = {
                 boxcollider = {
                     width = 32,
                     height = 25,
-                    offset = { x = 0, y = 5 }
+                    offset = { x = 0, y = 5 },
+                    category = collision_layer.player,
+                    collides_with = collision_layer.enemies | collision_layer.obstacles
                 },
                 health = {
                     max_health = 100
@@ -96,7 +109,9 @@ Level = {
                 boxcollider = {
                     width = 25,
                     height = 18,
-                    offset = { x = 0, y = 7 }
+                    offset = { x = 0, y = 7 },
+                    category = collision_layer.enemies,
+                    collides_with = collision_layer.player | collision_layer.obstacles
                 },
                 health = {
                     max_health = 100
@@ -128,7 +143,9 @@ Level = {
                 boxcollider = {
                     width = 25,
                     height = 18,
-                    offset = { x = 0, y = 7 }
+                    offset = { x = 0, y = 7 },
+                    category = collision_layer.enemies,
+                    collides_with = collision_layer.player | collision_layer.obstacles
                 },
                 health = {
                     max_health = 100
@@ -145,6 +162,12 @@ Level = {
                     function(entity, delta_time, elapsed_time) 
                         print("Truck update script")
                     end
+                },
+                on_collision_script = {
+                    [0] = 
+                    function(entity, other) 
+                        print("Truck hit entity "..other:get_id())
+                    end
                 }
             }
         },
@@ -166,7 +189,9 @@ Level = {
                 boxcollider = {
                     width = 25,
                     height = 18,
-                    offset = { x = 0, y = 7 }
+                    offset = { x = 0, y = 7 },
+                    category = collision_layer.enemies,
+                    collides_with = collision_layer.player | collision_layer.obstacles
                 },
                 health = {
                     max_health = 100
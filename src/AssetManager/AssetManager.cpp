@@ -48,4 +48,21 @@ void AssetManager::AddFont(const std::string& assetId, const std::string& path,
 
 TTF_Font* AssetManager::GetFont(const std::string& assetId) const {
     return fonts_.at(assetId);
-}
\ No newline at end of file
+}
+
+void AssetManager::GetMemoryUsage(std::vector<MemoryUsage>& usage) const {
+    size_t textureBytes = 0;
+
+    for (const auto& texture : textures_) {
+        Uint32 format = 0;
+        int width = 0;
+        int height = 0;
+
+        if (texture.second && SDL_QueryTexture(texture.second, &format, nullptr, &width, &height) == 0) {
+            textureBytes += static_cast<size_t>(width) * height * SDL_BYTESPERPIXEL(format);
+        }
+    }
+
+    usage.push_back({"Textures", static_cast<int>(textures_.size()), textureBytes, textureBytes, EstimateTreeBytes(textures_)});
+    usage.push_back({"Fonts", static_cast<int>(fonts_.size()), 0, 0, EstimateTreeBytes(fonts_)});
+}
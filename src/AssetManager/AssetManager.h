@@ -5,6 +5,9 @@
 
 #include <map>
 #include <string>
+#include <vector>
+
+#include "../General/MemoryTracker.h"
 
 class AssetManager {
    private:
@@ -20,4 +23,8 @@ class AssetManager {
     SDL_Texture* GetTexture(const std::string& assetId) const;
     void AddFont(const std::string& assetId, const std::string& path, const int fontSize);
     TTF_Font* GetFont(const std::string& assetId) const;
+
+    // Texture memory is estimated from each texture's size and format, as it
+    // lives with the renderer. Font memory is not known to SDL_ttf.
+    void GetMemoryUsage(std::vector<MemoryUsage>& usage) const;
 };
\ No newline at end of file
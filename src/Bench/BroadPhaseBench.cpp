@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <sol/sol.hpp>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../AssetManager/AssetManager.h"
+#include "../Components/BoxColliderComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Components/TransformComponent.h"
+#include "../ECS/ECS.h"
+#include "../Game/Game.h"
+#include "../Game/LevelLoader.h"
+#include "../Physics/AABBTreeBroadPhase.h"
+#include "../Physics/BroadPhase.h"
+#include "../Physics/BruteForceBroadPhase.h"
+#include "../Physics/SpatialHashGrid.h"
+#include "../Physics/SweepAndPrune.h"
+#include "../Systems/CollisionSystem.h"
+#include "../Systems/MovementSystem.h"
+#include "../Systems/ScriptSystem.h"
+
+// Frames timed per scene, after one untimed frame that lets the incremental
+// broad phases build their state.
+const int kBenchFrames = 30;
+// Brute force is quadratic, so it is only timed up to this many colliders.
+const int kMaxBruteForceColliders = 10000;
+// Scaling scenes keep one collider per this many square pixels, so only the
+// count changes between them.
+const float kBenchAreaPerCollider = 96.0f * 96.0f;
+// One collider in this many is static, like the obstacles in the levels.
+const int kBenchStaticEvery = 4;
+// Level bodies move by their velocity over one tick of this length.
+const float kBenchTickSeconds = 1.0f / 60.0f;
+
+struct BenchBody {
+    glm::vec2 position;
+    // Pixels per frame.
+    glm::vec2 velocity;
+    glm::vec2 size;
+    bool isStatic;
+    uint32_t category;
+    uint32_t collidesWith;
+};
+
+struct BenchScene {
+    std::string name;
+    std::vector<BenchBody> bodies;
+    glm::vec2 worldSize;
+};
+
+struct BenchPhase {
+    const char* name;
+    std::unique_ptr<IBroadPhase> broadPhase;
+    double milliseconds;
+    size_t pairCount;
+    bool isMatching;
+};
+
+static BenchScene CreateUniformScene(const char* name, int count, unsigned int seed) {
+    BenchScene scene = {name, {}, glm::vec2(std::sqrt(count * kBenchAreaPerCollider))};
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> position(0.0f, scene.worldSize.x);
+    std::uniform_real_distribution<float> speed(-2.0f, 2.0f);
+
+    scene.bodies.reserve(count);
+    for (int i = 0; i < count; i++) {
+        const bool isStatic = i % kBenchStaticEvery == 0;
+        scene.bodies.push_back({
+            glm::vec2(position(random), position(random)),
+            isStatic ? glm::vec2(0) : glm::vec2(speed(random), speed(random)),
+            glm::vec2(32.0f, 25.0f),
+            isStatic,
+            LAYER_DEFAULT,
+            kCollideWithAll});
+    }
+
+    return scene;
+}
+
+// Loads the level's colliders the way the game does, without a renderer.
+// Each copy past the first puts every collider of the level again at a
+// random place on the map, for a crowded version of the same mix of layers.
+static BenchScene LoadLevelScene(int levelNumber, int copies, unsigned int seed) {
+    sol::state lua;
+    lua.open_libraries(sol::lib::base, sol::lib::math, sol::lib::io);
+    lua["game_window_width"] = Game::windowWidth;
+    lua["game_window_height"] = Game::windowHeight;
+
+    auto registry = std::make_unique<Registry>();
+    std::unique_ptr<AssetManager> assetManager;
+    registry->AddSystem<MovementSystem>();
+    registry->AddSystem<CollisionSystem>();
+    registry->AddSystem<ScriptSystem>();
+    registry->GetSystem<ScriptSystem>().CreateLuaBindings(lua);
+
+    LevelLoader loader;
+    loader.LoadLevel(lua, registry, assetManager, nullptr, levelNumber);
+    registry->Update();
+
+    const std::string name = "level" + std::to_string(levelNumber) + (copies > 1 ? " x" + std::to_string(copies) : "");
+    BenchScene scene = {name, {}, glm::vec2(Game::mapWidth, Game::mapHeight)};
+    std::vector<BenchBody> level;
+
+    for (auto entity : registry->GetSystem<CollisionSystem>().GetEntities()) {
+        const auto& transform = entity.GetComponent<TransformComponent>();
+        const auto& collider = entity.GetComponent<BoxColliderComponent>();
+        const AABB bounds = CollisionSystem::GetColliderBounds(transform, collider);
+        const bool hasBody = entity.HasComponent<RigidBodyComponent>();
+
+        level.push_back({
+            bounds.min,
+            hasBody ? entity.GetComponent<RigidBodyComponent>().velocity * kBenchTickSeconds : glm::vec2(0),
+            bounds.max - bounds.min,
+            !hasBody,
+            collider.category,
+            collider.collidesWith});
+    }
+
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> x(0.0f, scene.worldSize.x);
+    std::uniform_real_distribution<float> y(0.0f, scene.worldSize.y);
+
+    for (int copy = 0; copy < copies; copy++) {
+        for (auto body : level) {
+            if (copy > 0) {
+                body.position = glm::vec2(x(random), y(random));
+            }
+            scene.bodies.push_back(body);
+        }
+    }
+
+    return scene;
+}
+
+// Moves the bodies a frame, bouncing them off the edges of the world.
+static void StepScene(BenchScene& scene) {
+    for (auto& body : scene.bodies) {
+        body.position += body.velocity;
+
+        for (int axis = 0; axis < 2; axis++) {
+            if (body.position[axis] < 0.0f || body.position[axis] + body.size[axis] > scene.worldSize[axis]) {
+                body.velocity[axis] = -body.velocity[axis];
+            }
+        }
+    }
+}
+
+static void BuildProxies(const BenchScene& scene, Registry& registry, std::vector<ColliderProxy>& proxies) {
+    proxies.clear();
+
+    for (int i = 0; i < static_cast<int>(scene.bodies.size()); i++) {
+        const auto& body = scene.bodies[i];
+        proxies.emplace_back(Entity(i, &registry), AABB(body.position, body.position + body.size), body.isStatic, body.category, body.collidesWith);
+    }
+}
+
+// The pairs that really overlap, as sorted entity id pairs. Broad phases may
+// skip static pairs and may report pairs that only nearly touch, so neither
+// takes part in the comparison.
+static std::vector<std::pair<int, int>> GetOverlappingPairs(const std::vector<ColliderProxy>& proxies, const std::vector<CollisionPair>& pairs) {
+    std::vector<std::pair<int, int>> overlapping;
+
+    for (const auto& pair : pairs) {
+        const auto& a = proxies[pair.a];
+        const auto& b = proxies[pair.b];
+
+        if ((a.isStatic && b.isStatic) || !a.bounds.Overlaps(b.bounds)) {
+            continue;
+        }
+
+        overlapping.emplace_back(std::min(a.entity.GetId(), b.entity.GetId()), std::max(a.entity.GetId(), b.entity.GetId()));
+    }
+
+    std::sort(overlapping.begin(), overlapping.end());
+    return overlapping;
+}
+
+// Times every broad phase on the scene. The first phase that runs is the
+// reference the others have to match on the last frame.
+static void RunScene(BenchScene& scene) {
+    const int count = static_cast<int>(scene.bodies.size());
+    std::vector<BenchPhase> phases;
+    if (count <= kMaxBruteForceColliders) {
+        phases.push_back({"brute", std::make_unique<BruteForceBroadPhase>(), 0.0, 0, true});
+    }
+    phases.push_back({"grid", std::make_unique<SpatialHashGrid>(kDefaultCellSize), 0.0, 0, true});
+    phases.push_back({"sap", std::make_unique<SweepAndPrune>(), 0.0, 0, true});
+    phases.push_back({"tree", std::make_unique<AABBTreeBroadPhase>(kDefaultAABBMargin), 0.0, 0, true});
+
+    Registry registry;
+    std::vector<ColliderProxy> proxies;
+    std::vector<CollisionPair> pairs;
+    std::vector<std::pair<int, int>> reference;
+
+    for (int frame = 0; frame <= kBenchFrames; frame++) {
+        StepScene(scene);
+        BuildProxies(scene, registry, proxies);
+
+        for (auto& phase : phases) {
+            pairs.clear();
+            const auto start = std::chrono::steady_clock::now();
+            phase.broadPhase->FindPairs(proxies, pairs);
+            const auto end = std::chrono::steady_clock::now();
+
+            if (frame > 0) {
+                phase.milliseconds += std::chrono::duration<double, std::milli>(end - start).count() / kBenchFrames;
+            }
+
+            if (frame == kBenchFrames) {
+                auto overlapping = GetOverlappingPairs(proxies, pairs);
+                phase.pairCount = overlapping.size();
+
+                if (&phase == &phases.front()) {
+                    reference = std::move(overlapping);
+                } else {
+                    phase.isMatching = overlapping == reference;
+                }
+            }
+        }
+    }
+
+    std::printf("%-12s %8d", scene.name.c_str(), count);
+    for (const char* name : {"brute", "grid", "sap", "tree"}) {
+        auto phase = std::find_if(phases.begin(), phases.end(), [name](const BenchPhase& other) {
+            return std::string(other.name) == name;
+        });
+
+        if (phase == phases.end()) {
+            std::printf(" %10s", "-");
+        } else {
+            std::printf(" %9.4f%s", phase->milliseconds, phase->isMatching ? " " : "!");
+        }
+    }
+    std::printf(" %8zu\n", reference.size());
+}
+
+/**
+ * Times the broad phases on the same moving colliders and checks they find
+ * the same overlapping pairs. Level scenes are the colliders of our levels,
+ * alone and copied across the map. Scaling scenes keep the density fixed
+ * from 100 to 100k colliders, so the curve shows how each phase grows with
+ * the count. Times are milliseconds per frame, and ! marks a phase whose
+ * pairs differ from the first phase's.
+ *
+ * Run from the repository root so the level scripts are found.
+ */
+int main() {
+    // Loading a level logs every entity it creates.
+    spdlog::set_level(spdlog::level::warn);
+
+    std::printf("%-12s %8s %10s %10s %10s %10s %8s\n", "scene", "count", "brute ms", "grid ms", "sap ms", "tree ms", "pairs");
+
+    for (int copies : {1, 100, 1000}) {
+        auto scene = LoadLevelScene(1, copies, 11);
+        RunScene(scene);
+    }
+
+    for (int count : {100, 300, 1000, 3000, 10000, 30000, 100000}) {
+        auto scene = CreateUniformScene("uniform", count, 7);
+        RunScene(scene);
+    }
+
+    return 0;
+}
@@ -0,0 +1,315 @@
+#include "BulletManager.h"
+
+#include <algorithm>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#define BULLET_MANAGER_SSE2
+#include <immintrin.h>
+#endif
+
+BulletManager::BulletManager()
+    : position_x_(),
+      position_y_(),
+      velocity_x_(),
+      velocity_y_(),
+      lifetime_(),
+      damage_(),
+      faction_(),
+      target_bounds_(),
+      target_faction_(),
+      grid_bounds_(),
+      inverse_cell_size_(1.0f / kBulletTargetCellSize),
+      grid_columns_(0),
+      grid_rows_(0),
+      cell_starts_(),
+      cell_targets_(),
+      vertices_(),
+      indices_() {
+    position_x_.reserve(kInitialBulletCapacity);
+    position_y_.reserve(kInitialBulletCapacity);
+    velocity_x_.reserve(kInitialBulletCapacity);
+    velocity_y_.reserve(kInitialBulletCapacity);
+    lifetime_.reserve(kInitialBulletCapacity);
+    damage_.reserve(kInitialBulletCapacity);
+    faction_.reserve(kInitialBulletCapacity);
+}
+
+void BulletManager::Spawn(glm::vec2 position, glm::vec2 velocity, float lifetime, int damage, BulletFaction faction) {
+    position_x_.push_back(position.x);
+    position_y_.push_back(position.y);
+    velocity_x_.push_back(velocity.x);
+    velocity_y_.push_back(velocity.y);
+    lifetime_.push_back(lifetime);
+    damage_.push_back(damage);
+    faction_.push_back(faction);
+}
+
+void BulletManager::Clear() {
+    position_x_.clear();
+    position_y_.clear();
+    velocity_x_.clear();
+    velocity_y_.clear();
+    lifetime_.clear();
+    damage_.clear();
+    faction_.clear();
+}
+
+int BulletManager::AddTarget(const AABB& bounds, BulletFaction faction) {
+    target_bounds_.push_back(bounds.Expanded(kBulletSize * 0.5f));
+    target_faction_.push_back(faction);
+    return static_cast<int>(target_bounds_.size()) - 1;
+}
+
+void BulletManager::ClearTargets() {
+    target_bounds_.clear();
+    target_faction_.clear();
+}
+
+MemoryUsage BulletManager::GetMemoryUsage() const {
+    const size_t bulletBytes = 5 * sizeof(float) + sizeof(int) + sizeof(uint8_t);
+    const size_t reservedBytes = (position_x_.capacity() + position_y_.capacity() + velocity_x_.capacity() + velocity_y_.capacity() + lifetime_.capacity()) * sizeof(float) +
+                                 damage_.capacity() * sizeof(int) + faction_.capacity() * sizeof(uint8_t);
+    // Targets, the grid and the vertex buffers are rebuilt every frame.
+    const size_t overheadBytes = target_bounds_.capacity() * sizeof(AABB) + target_faction_.capacity() * sizeof(uint8_t) +
+                                 (cell_starts_.capacity() + cell_targets_.capacity() + indices_.capacity()) * sizeof(int) +
+                                 vertices_.capacity() * sizeof(SDL_Vertex);
+
+    return {"Bullets", GetCount(), GetCount() * bulletBytes, reservedBytes, overheadBytes};
+}
+
+void BulletManager::Update(float deltaTime, const TileGrid& tileGrid, const AABB& worldBounds, std::vector<BulletHit>& hits) {
+    Integrate(deltaTime);
+    BuildTargetGrid();
+
+    const bool hasTerrain = !tileGrid.IsEmpty();
+    const float tileSize = tileGrid.GetTileSize();
+    const int count = GetCount();
+    int aliveCount = 0;
+
+    // Survivors are packed to the front in place, keeping their order.
+    for (int i = 0; i < count; i++) {
+        const glm::vec2 position(position_x_[i], position_y_[i]);
+
+        if (lifetime_[i] <= 0.0f || !worldBounds.Contains(position)) {
+            continue;
+        }
+
+        // Bullets are tested along the step they just took, so a fast one
+        // cannot pass through a wall or a target between two frames. Steps
+        // within a tile cannot skip one, so only the end tile is checked.
+        const glm::vec2 step = glm::vec2(velocity_x_[i], velocity_y_[i]) * deltaTime;
+        const glm::vec2 previous = position - step;
+        glm::vec2 end = position;
+        bool isBlocked = false;
+
+        if (hasTerrain) {
+            if (glm::dot(step, step) > tileSize * tileSize) {
+                float fraction;
+                if (tileGrid.Raycast(previous, position, TileFlags::TILE_BLOCKS_PROJECTILES, fraction)) {
+                    end = previous + step * fraction;
+                    isBlocked = true;
+                }
+            } else {
+                isBlocked = (tileGrid.GetFlagsAt(position) & TileFlags::TILE_BLOCKS_PROJECTILES) != 0;
+            }
+        }
+
+        // Targets in front of the wall are still hit.
+        const int target = FindTarget(previous, end, faction_[i]);
+        if (target != -1) {
+            hits.push_back({target, damage_[i]});
+            continue;
+        }
+
+        if (isBlocked) {
+            continue;
+        }
+
+        if (aliveCount != i) {
+            CopyBullet(i, aliveCount);
+        }
+        aliveCount++;
+    }
+
+    position_x_.resize(aliveCount);
+    position_y_.resize(aliveCount);
+    velocity_x_.resize(aliveCount);
+    velocity_y_.resize(aliveCount);
+    lifetime_.resize(aliveCount);
+    damage_.resize(aliveCount);
+    faction_.resize(aliveCount);
+}
+
+void BulletManager::Render(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect& camera, float timeOffset) {
+    const float halfSize = kBulletSize * 0.5f;
+    const SDL_Color color = {255, 255, 255, 255};
+    const int count = GetCount();
+
+    vertices_.clear();
+
+    for (int i = 0; i < count; i++) {
+        const float x = position_x_[i] + velocity_x_[i] * timeOffset - camera.x;
+        const float y = position_y_[i] + velocity_y_[i] * timeOffset - camera.y;
+
+        if (x + halfSize < 0 || x - halfSize > camera.w || y + halfSize < 0 || y - halfSize > camera.h) {
+            continue;
+        }
+
+        vertices_.push_back({{x - halfSize, y - halfSize}, color, {0.0f, 0.0f}});
+        vertices_.push_back({{x + halfSize, y - halfSize}, color, {1.0f, 0.0f}});
+        vertices_.push_back({{x + halfSize, y + halfSize}, color, {1.0f, 1.0f}});
+        vertices_.push_back({{x - halfSize, y + halfSize}, color, {0.0f, 1.0f}});
+    }
+
+    const int quadCount = static_cast<int>(vertices_.size()) / 4;
+    if (quadCount == 0) {
+        return;
+    }
+
+    // Every quad uses the same index pattern, so the indices only ever grow.
+    for (int quad = static_cast<int>(indices_.size()) / 6; quad < quadCount; quad++) {
+        const int first = quad * 4;
+        indices_.insert(indices_.end(), {first, first + 1, first + 2, first, first + 2, first + 3});
+    }
+
+    SDL_RenderGeometry(renderer, texture, vertices_.data(), static_cast<int>(vertices_.size()), indices_.data(), quadCount * 6);
+}
+
+void BulletManager::Integrate(float deltaTime) {
+    const int count = GetCount();
+    float* positionX = position_x_.data();
+    float* positionY = position_y_.data();
+    float* lifetime = lifetime_.data();
+    const float* velocityX = velocity_x_.data();
+    const float* velocityY = velocity_y_.data();
+    int i = 0;
+
+#ifdef BULLET_MANAGER_SSE2
+    const __m128 delta = _mm_set1_ps(deltaTime);
+
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(positionX + i, _mm_add_ps(_mm_loadu_ps(positionX + i), _mm_mul_ps(_mm_loadu_ps(velocityX + i), delta)));
+        _mm_storeu_ps(positionY + i, _mm_add_ps(_mm_loadu_ps(positionY + i), _mm_mul_ps(_mm_loadu_ps(velocityY + i), delta)));
+        _mm_storeu_ps(lifetime + i, _mm_sub_ps(_mm_loadu_ps(lifetime + i), delta));
+    }
+#endif
+
+    for (; i < count; i++) {
+        positionX[i] += velocityX[i] * deltaTime;
+        positionY[i] += velocityY[i] * deltaTime;
+        lifetime[i] -= deltaTime;
+    }
+}
+
+void BulletManager::BuildTargetGrid() {
+    const int targetCount = static_cast<int>(target_bounds_.size());
+
+    cell_starts_.clear();
+    cell_targets_.clear();
+    grid_columns_ = 0;
+    grid_rows_ = 0;
+
+    if (targetCount == 0) {
+        return;
+    }
+
+    grid_bounds_ = target_bounds_[0];
+    for (int i = 1; i < targetCount; i++) {
+        grid_bounds_ = AABB::Combine(grid_bounds_, target_bounds_[i]);
+    }
+
+    // Grow the cells until the grid is in proportion to the targets, so a few
+    // targets far apart do not make a huge grid.
+    const glm::vec2 size = grid_bounds_.max - grid_bounds_.min;
+    const int maxCells = std::max(targetCount * 4, 16);
+    float cellSize = kBulletTargetCellSize;
+
+    while ((size.x / cellSize + 1.0f) * (size.y / cellSize + 1.0f) > maxCells) {
+        cellSize *= 2.0f;
+    }
+
+    inverse_cell_size_ = 1.0f / cellSize;
+    grid_columns_ = static_cast<int>(size.x * inverse_cell_size_) + 1;
+    grid_rows_ = static_cast<int>(size.y * inverse_cell_size_) + 1;
+
+    const int cellCount = grid_columns_ * grid_rows_;
+    cell_starts_.assign(cellCount + 1, 0);
+
+    // Count the targets per cell, turn the counts into end offsets, then fill
+    // each cell backwards so every start lands on its first target.
+    int firstColumn, firstRow, lastColumn, lastRow;
+    for (int i = 0; i < targetCount; i++) {
+        GetCellRange(target_bounds_[i], firstColumn, firstRow, lastColumn, lastRow);
+        for (int row = firstRow; row <= lastRow; row++) {
+            for (int column = firstColumn; column <= lastColumn; column++) {
+                cell_starts_[row * grid_columns_ + column]++;
+            }
+        }
+    }
+
+    for (int cell = 1; cell < cellCount; cell++) {
+        cell_starts_[cell] += cell_starts_[cell - 1];
+    }
+    cell_starts_[cellCount] = cell_starts_[cellCount - 1];
+    cell_targets_.resize(cell_starts_[cellCount]);
+
+    for (int i = targetCount - 1; i >= 0; i--) {
+        GetCellRange(target_bounds_[i], firstColumn, firstRow, lastColumn, lastRow);
+        for (int row = firstRow; row <= lastRow; row++) {
+            for (int column = firstColumn; column <= lastColumn; column++) {
+                cell_targets_[--cell_starts_[row * grid_columns_ + column]] = i;
+            }
+        }
+    }
+}
+
+void BulletManager::GetCellRange(const AABB& bounds, int& firstColumn, int& firstRow, int& lastColumn, int& lastRow) const {
+    firstColumn = std::clamp(static_cast<int>((bounds.min.x - grid_bounds_.min.x) * inverse_cell_size_), 0, grid_columns_ - 1);
+    firstRow = std::clamp(static_cast<int>((bounds.min.y - grid_bounds_.min.y) * inverse_cell_size_), 0, grid_rows_ - 1);
+    lastColumn = std::clamp(static_cast<int>((bounds.max.x - grid_bounds_.min.x) * inverse_cell_size_), 0, grid_columns_ - 1);
+    lastRow = std::clamp(static_cast<int>((bounds.max.y - grid_bounds_.min.y) * inverse_cell_size_), 0, grid_rows_ - 1);
+}
+
+int BulletManager::FindTarget(glm::vec2 from, glm::vec2 to, uint8_t faction) const {
+    const AABB segmentBounds(glm::min(from, to), glm::max(from, to));
+
+    if (grid_columns_ == 0 || !grid_bounds_.Overlaps(segmentBounds)) {
+        return -1;
+    }
+
+    // A target over several cells may be tested more than once, which is
+    // cheaper than tracking the ones already seen.
+    int firstColumn, firstRow, lastColumn, lastRow;
+    GetCellRange(segmentBounds, firstColumn, firstRow, lastColumn, lastRow);
+
+    int nearestTarget = -1;
+    float nearestFraction = 1.0f;
+
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int column = firstColumn; column <= lastColumn; column++) {
+            const int cell = row * grid_columns_ + column;
+
+            for (int i = cell_starts_[cell]; i < cell_starts_[cell + 1]; i++) {
+                const int target = cell_targets_[i];
+                float fraction;
+
+                if (target_faction_[target] != faction && target_bounds_[target].Raycast(from, to, fraction) && (nearestTarget == -1 || fraction < nearestFraction)) {
+                    nearestTarget = target;
+                    nearestFraction = fraction;
+                }
+            }
+        }
+    }
+
+    return nearestTarget;
+}
+
+void BulletManager::CopyBullet(int from, int to) {
+    position_x_[to] = position_x_[from];
+    position_y_[to] = position_y_[from];
+    velocity_x_[to] = velocity_x_[from];
+    velocity_y_[to] = velocity_y_[from];
+    lifetime_[to] = lifetime_[from];
+    damage_[to] = damage_[from];
+    faction_[to] = faction_[from];
+}
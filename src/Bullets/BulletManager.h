@@ -0,0 +1,101 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "../General/MemoryTracker.h"
+#include "../Physics/AABB.h"
+#include "../Physics/TileGrid.h"
+
+// Bullets are drawn and collided as squares of this size around their center.
+const float kBulletSize = 4.0f;
+// Bullet arrays start with room for this many, so the first volleys do not
+// grow them mid-frame.
+const int kInitialBulletCapacity = 1024;
+// Targets are bucketed into cells of at least this size.
+const float kBulletTargetCellSize = 64.0f;
+
+// Bullets only hit targets of the other faction.
+enum BulletFaction : uint8_t {
+    FACTION_PLAYER,
+    FACTION_ENEMIES
+};
+
+struct BulletHit {
+    // The index the target was added with.
+    int target;
+    int damage;
+};
+
+/**
+ * Owns every live bullet in one array per field, so a frame of bullets is
+ * moved with a SIMD kernel instead of a walk over entities. Bullets are tested
+ * against the few damageable targets through a uniform grid, die on terrain
+ * that blocks projectiles, and are drawn with a single geometry call.
+ */
+class BulletManager {
+   private:
+    std::vector<float> position_x_;
+    std::vector<float> position_y_;
+    std::vector<float> velocity_x_;
+    std::vector<float> velocity_y_;
+    // Seconds left to live.
+    std::vector<float> lifetime_;
+    std::vector<int> damage_;
+    std::vector<uint8_t> faction_;
+
+    // Target bounds grown by half a bullet, so bullets test as points.
+    std::vector<AABB> target_bounds_;
+    std::vector<uint8_t> target_faction_;
+
+    // The targets of each cell are cell_targets_[cell_starts_[cell]] up to
+    // cell_targets_[cell_starts_[cell + 1]], rebuilt every update.
+    AABB grid_bounds_;
+    float inverse_cell_size_;
+    int grid_columns_;
+    int grid_rows_;
+    std::vector<int> cell_starts_;
+    std::vector<int> cell_targets_;
+
+    std::vector<SDL_Vertex> vertices_;
+    std::vector<int> indices_;
+
+    void Integrate(float deltaTime);
+    void BuildTargetGrid();
+    void GetCellRange(const AABB& bounds, int& firstColumn, int& firstRow, int& lastColumn, int& lastRow) const;
+    // Returns the first target the bullet hits moving from -> to, or -1.
+    int FindTarget(glm::vec2 from, glm::vec2 to, uint8_t faction) const;
+    void CopyBullet(int from, int to);
+
+   public:
+    BulletManager();
+    ~BulletManager() = default;
+
+    void Spawn(glm::vec2 position, glm::vec2 velocity, float lifetime, int damage, BulletFaction faction);
+
+    void Clear();
+
+    int GetCount() const {
+        return static_cast<int>(position_x_.size());
+    }
+
+    // Targets are kept until the next ClearTargets. Returns the target index
+    // reported in hits.
+    int AddTarget(const AABB& bounds, BulletFaction faction);
+
+    void ClearTargets();
+
+    MemoryUsage GetMemoryUsage() const;
+
+    // Moves every bullet and removes the ones that expired, left the world,
+    // flew into a tile that blocks projectiles or hit a target. Hits are
+    // appended, and a bullet hits at most one target.
+    void Update(float deltaTime, const TileGrid& tileGrid, const AABB& worldBounds, std::vector<BulletHit>& hits);
+
+    // Draws the bullets inside the camera with one geometry call. Bullets are
+    // drawn moved along their velocity by timeOffset seconds.
+    void Render(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect& camera, float timeOffset);
+};
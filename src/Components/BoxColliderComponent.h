@@ -1,15 +1,42 @@
 #pragma once
 
+#include <cstdint>
 #include <glm/glm.hpp>
 
+// Collision layers used by the engine for the colliders it creates. Levels can
+// combine these through the collision_layer table exposed to Lua. Bullets are
+// not colliders, so the projectile layers only remain for scripts that still
+// name them.
+enum CollisionLayer : uint32_t {
+    LAYER_DEFAULT = 1u << 0,
+    LAYER_PLAYER = 1u << 1,
+    LAYER_ENEMIES = 1u << 2,
+    LAYER_PLAYER_PROJECTILES = 1u << 3,
+    LAYER_ENEMY_PROJECTILES = 1u << 4,
+    LAYER_OBSTACLES = 1u << 5,
+    LAYER_UI = 1u << 6
+};
+
+const uint32_t kCollideWithAll = 0xFFFFFFFFu;
+
 struct BoxColliderComponent {
     int width;
     int height;
     glm::vec2 offset;
+    // The layers this collider is on and the layers it reports collisions with.
+    uint32_t category;
+    uint32_t collidesWith;
 
-    BoxColliderComponent(int width = 0, int height = 0, glm::vec2 offset = glm::vec2(0)) {
+    BoxColliderComponent(
+        int width = 0,
+        int height = 0,
+        glm::vec2 offset = glm::vec2(0),
+        uint32_t category = LAYER_DEFAULT,
+        uint32_t collidesWith = kCollideWithAll) {
         this->width = width;
         this->height = height;
         this->offset = offset;
+        this->category = category;
+        this->collidesWith = collidesWith;
     }
 };
@@ -1,16 +1,17 @@
 #pragma once
 
-#include <SDL2/SDL.h>
-
 #include <glm/glm.hpp>
 
+#include "../General/TimerWheel.h"
+
 struct ProjectileEmitterComponent {
     glm::vec2 velocity;
     int duration;
     int frequency;
     int damage;
     bool isFriendly;
-    int lastEmissionTime;
+    // Repeats every frequency milliseconds while an enemy emitter is alive.
+    TimerHandle emissionTimer;
 
     ProjectileEmitterComponent(
         glm::vec2 velocity = glm::vec2(0, 0),
@@ -22,6 +23,6 @@ struct ProjectileEmitterComponent {
                                   frequency(frequency),
                                   damage(damage),
                                   isFriendly(isFriendly),
-                                  lastEmissionTime(SDL_GetTicks()) {
+                                  emissionTimer() {
     }
 };
\ No newline at end of file
@@ -4,7 +4,34 @@
 
 struct RigidBodyComponent {
     glm::vec2 velocity;
+    // Bodies without mass are moved by gameplay code and are never pushed by
+    // contacts. Bodies with mass are simulated by the physics system.
+    float mass;
+    // How much of the approach speed is kept after a contact, from 0 to 1.
+    float restitution;
+    float friction;
+    // Fraction of the velocity lost per second, like ground drag.
+    float linearDamping;
+    bool isSleeping;
+    // How long the body has been slow enough to sleep.
+    float sleepTime;
 
-    RigidBodyComponent(glm::vec2 velocity = glm::vec2(0, 0)) : velocity(velocity) {
+    RigidBodyComponent(
+        glm::vec2 velocity = glm::vec2(0, 0),
+        float mass = 0.0f,
+        float restitution = 0.0f,
+        float friction = 0.2f,
+        float linearDamping = 0.0f)
+        : velocity(velocity),
+          mass(mass),
+          restitution(restitution),
+          friction(friction),
+          linearDamping(linearDamping),
+          isSleeping(false),
+          sleepTime(0.0f) {
     }
-};
\ No newline at end of file
+
+    bool IsDynamic() const {
+        return mass > 0.0f;
+    }
+};
@@ -4,7 +4,13 @@
 
 struct ScriptComponent {
     sol::function updateFunction;
+    // Called with the entity and the other entity when a collision begins.
+    sol::function collisionFunction;
+    // The entity as a Lua value, made once when the script system takes the
+    // entity so calls do not allocate a new userdata each time.
+    sol::object luaEntity;
 
-    ScriptComponent(sol::function updateFunction = sol::lua_nil) : updateFunction(updateFunction) {
+    ScriptComponent(sol::function updateFunction = sol::lua_nil, sol::function collisionFunction = sol::lua_nil)
+        : updateFunction(updateFunction), collisionFunction(collisionFunction), luaEntity() {
     }
 };
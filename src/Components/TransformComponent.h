@@ -6,9 +6,24 @@ struct TransformComponent {
     glm::vec2 position;
     glm::vec2 scale;
     double rotation;
+    // Where the entity was at the start of the last simulation tick, so it
+    // can be drawn between ticks.
+    glm::vec2 previousPosition;
+    double previousRotation;
 
     TransformComponent(glm::vec2 position = glm::vec2(0, 0), glm::vec2 scale = glm::vec2(1, 1), double rotation = 0.0) : position(position),
                                                                                                                          scale(scale),
-                                                                                                                         rotation(rotation) {
+                                                                                                                         rotation(rotation),
+                                                                                                                         previousPosition(position),
+                                                                                                                         previousRotation(rotation) {
     }
-};
\ No newline at end of file
+
+    // Blends from the previous tick to the current one, alpha going 0 to 1.
+    glm::vec2 GetInterpolatedPosition(float alpha) const {
+        return glm::mix(previousPosition, position, alpha);
+    }
+
+    double GetInterpolatedRotation(float alpha) const {
+        return previousRotation + (rotation - previousRotation) * alpha;
+    }
+};
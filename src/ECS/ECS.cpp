@@ -16,6 +16,10 @@ int Entity::GetId() const {
     return id_;
 }
 
+const Signature& Entity::GetComponentSignature() const {
+    return registry_->GetComponentSignature(*this);
+}
+
 void Entity::Tag(const std::string& tag) {
     registry_->TagEntity(*this, tag);
 }
@@ -39,16 +43,21 @@ void Entity::Blam() {
 // Systems implementation
 void System::AddEntity(const Entity entity) {
     entities_.push_back(entity);
+    OnEntityAdded(entity);
 }
 
 void System::RemoveEntity(const Entity entity) {
-    entities_.erase(std::remove_if(
-                        entities_.begin(),
-                        entities_.end(),
-                        [&entity](const Entity& other) {
-                            return other == entity;
-                        }),
-                    entities_.end());
+    auto it = std::remove_if(
+        entities_.begin(),
+        entities_.end(),
+        [&entity](const Entity& other) {
+            return other == entity;
+        });
+
+    if (it != entities_.end()) {
+        entities_.erase(it, entities_.end());
+        OnEntityRemoved(entity);
+    }
 }
 
 // Registry implementation
@@ -79,6 +88,14 @@ void Registry::BlamEntity(const Entity entity) {
     entities_to_remove_.insert(entity);
 }
 
+void Registry::AddRemovalListener(IEntityRemovalListener* listener) {
+    removal_listeners_.push_back(listener);
+}
+
+void Registry::RemoveRemovalListener(IEntityRemovalListener* listener) {
+    removal_listeners_.erase(std::remove(removal_listeners_.begin(), removal_listeners_.end(), listener), removal_listeners_.end());
+}
+
 void Registry::AddEntityToSystems(Entity entity) {
     const auto entityId = entity.GetId();
 
@@ -111,6 +128,9 @@ void Registry::Update() {
 
     for (auto entity : entities_to_remove_) {
         RemoveEntityFromSystems(entity);
+        for (auto listener : removal_listeners_) {
+            listener->OnEntityDestroyed(entity);
+        }
         free_ids_.push_front(entity.GetId());
         entity_component_signatures_[entity.GetId()].reset();
 
@@ -222,4 +242,54 @@ void Registry::RemoveEntityGroups(Entity entity) {
         }
         groups_by_entity_.erase(entity.GetId());
     }
-}
\ No newline at end of file
+}
+
+void Registry::GetMemoryUsage(std::vector<MemoryUsage>& usage) const {
+    for (const auto& pool : component_pools_) {
+        if (pool) {
+            usage.push_back(pool->GetMemoryUsage());
+        }
+    }
+
+    size_t tagBytes = EstimateHashMapBytes(entity_by_tag_) + EstimateHashMapBytes(tag_by_entity_);
+    for (const auto& tag : entity_by_tag_) {
+        tagBytes += EstimateStringBytes(tag.first);
+    }
+    for (const auto& tag : tag_by_entity_) {
+        tagBytes += EstimateStringBytes(tag.second);
+    }
+    usage.push_back({"Tags", static_cast<int>(entity_by_tag_.size()), 0, 0, tagBytes});
+
+    size_t groupBytes = EstimateHashMapBytes(entities_by_groups_) + EstimateHashMapBytes(groups_by_entity_);
+    for (const auto& group : entities_by_groups_) {
+        groupBytes += EstimateStringBytes(group.first) + EstimateTreeBytes(group.second);
+    }
+    for (const auto& groups : groups_by_entity_) {
+        groupBytes += EstimateTreeBytes(groups.second);
+        for (const auto& group : groups.second) {
+            groupBytes += EstimateStringBytes(group);
+        }
+    }
+    usage.push_back({"Groups", static_cast<int>(entities_by_groups_.size()), 0, 0, groupBytes});
+
+    usage.push_back({
+        "Signatures",
+        static_cast<int>(entity_component_signatures_.size()),
+        entity_component_signatures_.size() * sizeof(Signature),
+        entity_component_signatures_.capacity() * sizeof(Signature),
+        0});
+
+    size_t systemUsedBytes = 0;
+    size_t systemReservedBytes = 0;
+    for (const auto& system : systems_) {
+        size_t usedBytes = 0;
+        size_t reservedBytes = 0;
+        system.second->GetEntityListBytes(usedBytes, reservedBytes);
+        systemUsedBytes += usedBytes;
+        systemReservedBytes += reservedBytes;
+    }
+    usage.push_back({"System entity lists", static_cast<int>(systems_.size()), systemUsedBytes, systemReservedBytes, EstimateHashMapBytes(systems_)});
+
+    const size_t pendingBytes = EstimateTreeBytes(entities_to_add_) + EstimateTreeBytes(entities_to_remove_) + free_ids_.size() * sizeof(int);
+    usage.push_back({"Pending and free ids", static_cast<int>(free_ids_.size()), 0, 0, pendingBytes});
+}
@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "../General/Logger.h"
+#include "../General/MemoryTracker.h"
 #include "../General/Pool.h"
 
 const unsigned int kMaxComponents = 32;
@@ -78,6 +79,8 @@ class Entity {
     template <typename T>
     T& GetComponent() const;
 
+    const Signature& GetComponentSignature() const;
+
     void Tag(const std::string& tag);
     bool HasTag(const std::string& tag) const;
     void Group(const std::string& group);
@@ -93,23 +96,55 @@ class System {
 
    public:
     System() = default;
-    ~System() = default;
+    virtual ~System() = default;
 
     const Signature& GetComponentSignature() const {
         return component_signature_;
     }
 
-    std::vector<Entity> GetEntities() const {
+    // Entities join and leave only in Registry::Update, so the list does not
+    // change while a system walks it.
+    const std::vector<Entity>& GetEntities() const {
         return entities_;
     }
 
+    int GetEntityCount() const {
+        return static_cast<int>(entities_.size());
+    }
+
     void AddEntity(const Entity entity);
     void RemoveEntity(const Entity entity);
 
+    // The entities in the list, and the bytes set aside for it.
+    void GetEntityListBytes(size_t& usedBytes, size_t& reservedBytes) const {
+        usedBytes = entities_.size() * sizeof(Entity);
+        reservedBytes = entities_.capacity() * sizeof(Entity);
+    }
+
+    // Called when an entity starts or stops matching the system. Entities
+    // being destroyed still have their components here.
+    virtual void OnEntityAdded(Entity entity) {}
+    virtual void OnEntityRemoved(Entity entity) {}
+
+    // Updates the entities whose id modulo partCount is part. Ids do not
+    // change as entities come and go, so each entity stays in one part.
+    // Systems that can be a few frames stale override this so the frame
+    // scheduler can spread them over frames when time is short.
+    virtual void UpdatePart(int part, int partCount) {}
+
     template <typename T>
     void RequireComponent();
 };
 
+// Told about every entity the registry destroys, after it has left the
+// systems and before its id can be reused. For bookkeeping outside the
+// systems, such as subscriptions scoped to the entity.
+class IEntityRemovalListener {
+   public:
+    virtual ~IEntityRemovalListener() = default;
+    virtual void OnEntityDestroyed(Entity entity) = 0;
+};
+
 /**
  * Manages the creation and destruction of entities, systems, and components.
  */
@@ -143,6 +178,8 @@ class Registry {
     // A queue of ids that have been freed from destroyed entities.
     std::deque<int> free_ids_;
 
+    std::vector<IEntityRemovalListener*> removal_listeners_;
+
    public:
     Registry() = default;
     ~Registry() = default;
@@ -152,8 +189,18 @@ class Registry {
     // Entity management
     Entity CreateEntity();
 
+    // Entities created and not yet destroyed, including ones still waiting
+    // to be added.
+    int GetEntityCount() const {
+        return num_entities_ - static_cast<int>(free_ids_.size());
+    }
+
     void BlamEntity(const Entity entity);
 
+    // The listener must outlive the registry or be removed first.
+    void AddRemovalListener(IEntityRemovalListener* listener);
+    void RemoveRemovalListener(IEntityRemovalListener* listener);
+
     // Tag management
     void TagEntity(Entity entity, const std::string& tag);
     bool EntityHasTag(Entity entity, const std::string& tag) const;
@@ -196,6 +243,14 @@ class Registry {
 
     template <typename T>
     T& GetComponent(const Entity entity) const;
+
+    const Signature& GetComponentSignature(const Entity entity) const {
+        return entity_component_signatures_[entity.GetId()];
+    }
+
+    // Appends what each component pool, the tag and group maps and the
+    // entity bookkeeping hold.
+    void GetMemoryUsage(std::vector<MemoryUsage>& usage) const;
 };
 
 // Entity implementations
@@ -1,53 +1,464 @@
 #pragma once
 
-#include <functional>
-#include <list>
-#include <map>
-#include <typeindex>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "../ECS/ECS.h"
 #include "../General/Logger.h"
 #include "Event.h"
+#include "EventSpan.h"
 
-class IEventCallback {
+struct IEventType {
+   protected:
+    // Atomic because the first GetId of a type may come from a worker thread
+    // appending to its lane. Each type's id is then fixed by its static, which
+    // is initialized once. Subscribing and dispatching stay on the main thread.
+    static inline std::atomic<int> next_id_{0};
+};
+
+// Gives every event type a small dense id so handlers can be found by index.
+template <typename TEvent>
+class EventType : public IEventType {
+   public:
+    static int GetId() {
+        static const int id = next_id_.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+};
+
+/**
+ * A handler stored by value: the owner, a copy of the member function pointer
+ * and a trampoline that knows both types. Calling one is a single indirect
+ * call, and storing one never allocates. The argument is an event for single
+ * event handlers and an EventSpan for batch handlers.
+ */
+class EventDelegate {
    private:
-    virtual void CallEvent(Event& e) = 0;
+    struct Dummy {
+        void Callback(const Event&) {}
+    };
+
+    typedef void (*Trampoline)(const EventDelegate& delegate, const void* argument);
+
+    void* owner_;
+    Trampoline trampoline_;
+    alignas(void (Dummy::*)(const Event&)) unsigned char callback_[sizeof(void (Dummy::*)(const Event&))];
+
+    template <typename TArgument, typename TOwner, typename TParameter>
+    static void Call(const EventDelegate& delegate, const void* argument) {
+        void (TOwner::*callback)(TParameter);
+        std::memcpy(&callback, delegate.callback_, sizeof(callback));
+        (static_cast<TOwner*>(delegate.owner_)->*callback)(*static_cast<const TArgument*>(argument));
+    }
 
    public:
-    virtual ~IEventCallback() = default;
+    template <typename TArgument, typename TOwner, typename TParameter>
+    static EventDelegate Create(TOwner* owner, void (TOwner::*callback)(TParameter)) {
+        static_assert(sizeof(callback) <= sizeof(callback_), "Member function pointer does not fit in an EventDelegate");
+
+        EventDelegate delegate;
+        delegate.owner_ = owner;
+        delegate.trampoline_ = &Call<TArgument, TOwner, TParameter>;
+        std::memcpy(delegate.callback_, &callback, sizeof(callback));
+        return delegate;
+    }
 
-    void Execute(Event& e) {
-        CallEvent(e);
+    void operator()(const void* argument) const {
+        trampoline_(*this, argument);
     }
 };
 
-template <typename TOwner, typename TEvent>
-class EventCallback : public IEventCallback {
+class EventBus;
+
+struct IEventQueue {
+    virtual ~IEventQueue() = default;
+
+    virtual void Flush(EventBus& eventBus) = 0;
+};
+
+/**
+ * The queued events of one type. Events are appended to one buffer while the
+ * other is being flushed, so handlers can queue more events without moving
+ * the ones they are reading. Worker threads append to lanes of their own,
+ * which are merged in lane order at the next flush. All buffers keep their
+ * capacity.
+ */
+template <typename TEvent>
+class EventQueue : public IEventQueue {
    private:
-    typedef void (TOwner::*CallbackFunction)(TEvent&);
+    // Padded so lanes written from different threads never share a cache
+    // line.
+    struct alignas(64) Lane {
+        std::vector<TEvent> events;
+    };
+
+    std::vector<TEvent> pending_;
+    std::vector<TEvent> flushing_;
+    std::vector<Lane> lanes_;
+    bool is_flushing_;
 
-    TOwner* owner_instance_;
-    CallbackFunction callback_function_;
-    virtual void CallEvent(Event& e) override {
-        std::invoke(callback_function_, owner_instance_, static_cast<TEvent&>(e));
+    void MergeLanes() {
+        for (auto& lane : lanes_) {
+            pending_.insert(pending_.end(), std::make_move_iterator(lane.events.begin()), std::make_move_iterator(lane.events.end()));
+            lane.events.clear();
+        }
     }
 
    public:
-    EventCallback(TOwner* ownerInstance, CallbackFunction callbackFunction) {
-        this->owner_instance_ = ownerInstance;
-        this->callback_function_ = callbackFunction;
+    EventQueue() : pending_(), flushing_(), lanes_(), is_flushing_(false) {
+    }
+
+    virtual ~EventQueue() override = default;
+
+    template <typename... TArgs>
+    void Push(TArgs&&... args) {
+        pending_.emplace_back(std::forward<TArgs>(args)...);
+    }
+
+    // Lanes are never removed, so publishers keep working after a smaller
+    // count is asked for.
+    void SetLaneCount(int count) {
+        if (count > static_cast<int>(lanes_.size())) {
+            lanes_.resize(count);
+        }
+    }
+
+    template <typename... TArgs>
+    void PushToLane(int lane, TArgs&&... args) {
+        lanes_[lane].events.emplace_back(std::forward<TArgs>(args)...);
     }
 
-    virtual ~EventCallback() override = default;
+    // Defined after EventBus.
+    virtual void Flush(EventBus& eventBus) override;
 };
 
-typedef std::list<std::unique_ptr<IEventCallback>> HandlerList;
+/**
+ * Lets worker threads queue events of one type without locks. Each thread
+ * publishes on its own lane, numbered from 0, and the lanes are merged in lane
+ * order when the type is flushed, so the order never depends on thread timing.
+ * Get the publisher before the workers start, and do not flush while they are
+ * publishing.
+ */
+template <typename TEvent>
+class EventPublisher {
+   private:
+    EventQueue<TEvent>* queue_;
+
+   public:
+    EventPublisher(EventQueue<TEvent>& queue) : queue_(&queue) {
+    }
+
+    template <typename... TArgs>
+    void Publish(int lane, TArgs&&... args) {
+        queue_->PushToLane(lane, std::forward<TArgs>(args)...);
+    }
+};
 
-class EventBus {
+/**
+ * Keeps a handler subscribed for as long as it lives. Owners keep one per
+ * subscription, so destroying the owner unsubscribes it. Must not outlive the
+ * event bus.
+ */
+class EventSubscription {
    private:
-    std::map<std::type_index, std::unique_ptr<HandlerList>> subscribers_;
+    EventBus* event_bus_;
+    int event_type_;
+    int id_;
+    // The entity of an entity scoped subscription, otherwise -1.
+    int entity_id_;
 
    public:
-    EventBus() {
+    EventSubscription() : event_bus_(nullptr), event_type_(-1), id_(-1), entity_id_(-1) {
+    }
+
+    EventSubscription(EventBus* eventBus, int eventType, int id, int entityId)
+        : event_bus_(eventBus), event_type_(eventType), id_(id), entity_id_(entityId) {
+    }
+
+    ~EventSubscription() {
+        Unsubscribe();
+    }
+
+    EventSubscription(const EventSubscription&) = delete;
+    EventSubscription& operator=(const EventSubscription&) = delete;
+
+    EventSubscription(EventSubscription&& other) noexcept
+        : event_bus_(other.event_bus_), event_type_(other.event_type_), id_(other.id_), entity_id_(other.entity_id_) {
+        other.event_bus_ = nullptr;
+    }
+
+    EventSubscription& operator=(EventSubscription&& other) noexcept {
+        if (this != &other) {
+            Unsubscribe();
+            event_bus_ = other.event_bus_;
+            event_type_ = other.event_type_;
+            id_ = other.id_;
+            entity_id_ = other.entity_id_;
+            other.event_bus_ = nullptr;
+        }
+        return *this;
+    }
+
+    bool IsSubscribed() const {
+        return event_bus_ != nullptr;
+    }
+
+    void Unsubscribe();
+};
+
+// Events about entities opt into scoped subscriptions by providing
+// int GetEntityCount() const and Entity GetEntity(int index) const.
+template <typename TEvent, typename = void>
+struct IsEntityEvent : std::false_type {};
+
+template <typename TEvent>
+struct IsEntityEvent<TEvent, std::void_t<decltype(std::declval<const TEvent&>().GetEntity(0))>> : std::true_type {};
+
+class EventBus : public IEntityRemovalListener {
+   private:
+    struct Handler {
+        EventDelegate delegate;
+        // kRemovedHandler once unsubscribed during a dispatch.
+        int id;
+        // Batch handlers take an EventSpan and only see queued events.
+        bool isBatch;
+    };
+
+    // A handler that only wants events about entities in a group or with
+    // every component of a signature.
+    struct FilteredHandler {
+        Handler handler;
+        std::string group;
+        Signature signature;
+    };
+
+    struct HandlerList {
+        // Handlers that get every event of the type, in subscription order.
+        std::vector<Handler> handlers;
+        // Entity scoped handlers by entity id.
+        std::vector<std::vector<Handler>> entityHandlers;
+        int entityHandlerCount = 0;
+        std::vector<FilteredHandler> filteredHandlers;
+    };
+
+    static const int kRemovedHandler = -1;
+
+    // Handlers by event type id.
+    std::vector<HandlerList> handlers_;
+    // Queues by event type id, created on first use.
+    std::vector<std::unique_ptr<IEventQueue>> queues_;
+    int next_subscription_id_;
+    // How many emits are running. Handlers are only erased when none are, so
+    // a handler can unsubscribe itself or others while being called.
+    int dispatch_depth_;
+    bool has_removed_handlers_;
+
+    static bool IsRemoved(const Handler& handler) {
+        return handler.id == kRemovedHandler;
+    }
+
+    void RemoveDeadHandlers() {
+        for (auto& list : handlers_) {
+            list.handlers.erase(std::remove_if(list.handlers.begin(), list.handlers.end(), IsRemoved), list.handlers.end());
+
+            for (auto& handlers : list.entityHandlers) {
+                handlers.erase(std::remove_if(handlers.begin(), handlers.end(), IsRemoved), handlers.end());
+            }
+
+            list.filteredHandlers.erase(
+                std::remove_if(list.filteredHandlers.begin(), list.filteredHandlers.end(), [](const FilteredHandler& filtered) { return IsRemoved(filtered.handler); }),
+                list.filteredHandlers.end());
+        }
+        has_removed_handlers_ = false;
+    }
+
+    // Marks the handler removed while a dispatch is running, otherwise erases
+    // it. Returns false if it is not in the list.
+    template <typename THandler, typename TGetHandler>
+    bool RemoveHandler(std::vector<THandler>& handlers, int id, TGetHandler getHandler) {
+        for (auto it = handlers.begin(); it != handlers.end(); it++) {
+            if (getHandler(*it).id != id) {
+                continue;
+            }
+
+            if (dispatch_depth_ > 0) {
+                getHandler(*it).id = kRemovedHandler;
+                has_removed_handlers_ = true;
+            } else {
+                handlers.erase(it);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    bool HasHandlers(int eventType) const {
+        if (eventType >= static_cast<int>(handlers_.size())) {
+            return false;
+        }
+        const auto& list = handlers_[eventType];
+        return !list.handlers.empty() || list.entityHandlerCount > 0 || !list.filteredHandlers.empty();
+    }
+
+    // True if the type has handlers that take single events.
+    bool HasEventHandlers(int eventType) const {
+        if (!HasHandlers(eventType)) {
+            return false;
+        }
+        const auto& list = handlers_[eventType];
+        if (list.entityHandlerCount > 0 || !list.filteredHandlers.empty()) {
+            return true;
+        }
+        for (const auto& handler : list.handlers) {
+            if (!IsRemoved(handler) && !handler.isBatch) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    HandlerList& GetHandlerList(int eventType) {
+        if (eventType >= static_cast<int>(handlers_.size())) {
+            handlers_.resize(eventType + 1);
+        }
+        return handlers_[eventType];
+    }
+
+    template <typename TArgument, typename TOwner, typename TParameter>
+    Handler CreateHandler(TOwner* ownerInstance, void (TOwner::*callbackFunction)(TParameter), bool isBatch) {
+        return {EventDelegate::Create<TArgument>(ownerInstance, callbackFunction), next_subscription_id_++, isBatch};
+    }
+
+    template <typename TEvent, typename TOwner>
+    EventSubscription AddFilteredHandler(TOwner* ownerInstance, void (TOwner::*callbackFunction)(const TEvent&), const std::string& group, const Signature& signature) {
+        static_assert(IsEntityEvent<TEvent>::value, "Only events about entities can be scoped");
+
+        const int eventType = EventType<TEvent>::GetId();
+        const Handler handler = CreateHandler<TEvent>(ownerInstance, callbackFunction, false);
+        GetHandlerList(eventType).filteredHandlers.push_back({handler, group, signature});
+        return EventSubscription(this, eventType, handler.id, -1);
+    }
+
+    template <typename TEvent>
+    EventQueue<TEvent>& GetQueue() {
+        const int eventType = EventType<TEvent>::GetId();
+        if (eventType >= static_cast<int>(queues_.size())) {
+            queues_.resize(eventType + 1);
+        }
+        if (!queues_[eventType]) {
+            queues_[eventType] = std::make_unique<EventQueue<TEvent>>();
+        }
+        return static_cast<EventQueue<TEvent>&>(*queues_[eventType]);
+    }
+
+    void EndDispatch() {
+        dispatch_depth_--;
+
+        if (dispatch_depth_ == 0 && has_removed_handlers_) {
+            RemoveDeadHandlers();
+        }
+    }
+
+    // Calls the unscoped handlers of one kind for an event type. The argument
+    // is an event or an EventSpan to match.
+    void Dispatch(int eventType, bool isBatch, const void* argument) {
+        if (!HasHandlers(eventType)) {
+            return;
+        }
+
+        const size_t count = handlers_[eventType].handlers.size();
+
+        dispatch_depth_++;
+
+        // Indexed and copied out so handlers that subscribe others do not
+        // invalidate the loop.
+        for (size_t i = 0; i < count; i++) {
+            const Handler handler = handlers_[eventType].handlers[i];
+            if (!IsRemoved(handler) && handler.isBatch == isBatch) {
+                handler.delegate(argument);
+            }
+        }
+
+        EndDispatch();
+    }
+
+    template <typename TEvent>
+    static bool Matches(const FilteredHandler& filtered, const TEvent& event) {
+        for (int i = 0; i < event.GetEntityCount(); i++) {
+            const Entity entity = event.GetEntity(i);
+            const bool isMatch = filtered.group.empty()
+                                     ? (entity.GetComponentSignature() & filtered.signature) == filtered.signature
+                                     : entity.InGroup(filtered.group);
+            if (isMatch) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Routes an event about entities to the handlers scoped to them. Each
+    // handler is called at most once per event.
+    template <typename TEvent>
+    void DispatchScoped(int eventType, const TEvent& event) {
+        dispatch_depth_++;
+
+        const int entityCount = event.GetEntityCount();
+        for (int e = 0; e < entityCount; e++) {
+            const int entityId = event.GetEntity(e).GetId();
+
+            bool isRepeat = false;
+            for (int previous = 0; previous < e; previous++) {
+                isRepeat = isRepeat || event.GetEntity(previous).GetId() == entityId;
+            }
+            if (isRepeat || entityId >= static_cast<int>(handlers_[eventType].entityHandlers.size())) {
+                continue;
+            }
+
+            const size_t count = handlers_[eventType].entityHandlers[entityId].size();
+            for (size_t i = 0; i < count; i++) {
+                const Handler handler = handlers_[eventType].entityHandlers[entityId][i];
+                if (!IsRemoved(handler)) {
+                    handler.delegate(&event);
+                }
+            }
+        }
+
+        const size_t count = handlers_[eventType].filteredHandlers.size();
+        for (size_t i = 0; i < count; i++) {
+            const auto& filtered = handlers_[eventType].filteredHandlers[i];
+            if (IsRemoved(filtered.handler) || !Matches(filtered, event)) {
+                continue;
+            }
+
+            const Handler handler = filtered.handler;
+            handler.delegate(&event);
+        }
+
+        EndDispatch();
+    }
+
+    // Sends a single event to every handler that takes single events.
+    template <typename TEvent>
+    void DispatchEvent(int eventType, const TEvent& event) {
+        Dispatch(eventType, false, &event);
+
+        if constexpr (IsEntityEvent<TEvent>::value) {
+            DispatchScoped(eventType, event);
+        }
+    }
+
+    template <typename TEvent>
+    friend class EventQueue;
+
+   public:
+    EventBus() : handlers_(), queues_(), next_subscription_id_(0), dispatch_depth_(0), has_removed_handlers_(false) {
         Logger::Info("Event bus created");
     }
 
@@ -55,29 +466,188 @@ class EventBus {
         Logger::Info("Event bus destructed");
     }
 
-    void Reset() {
-        subscribers_.clear();
+    template <typename TOwner, typename TEvent>
+    [[nodiscard]] EventSubscription SubscribeEvent(TOwner* ownerInstance, void (TOwner::*callbackFunction)(const TEvent&)) {
+        const int eventType = EventType<TEvent>::GetId();
+        const Handler handler = CreateHandler<TEvent>(ownerInstance, callbackFunction, false);
+        GetHandlerList(eventType).handlers.push_back(handler);
+        return EventSubscription(this, eventType, handler.id, -1);
+    }
+
+    // Batch handlers get every queued event of a type at once when it is
+    // flushed. Events sent with EmitEvent do not reach them.
+    template <typename TOwner, typename TEvent>
+    [[nodiscard]] EventSubscription SubscribeEvents(TOwner* ownerInstance, void (TOwner::*callbackFunction)(EventSpan<TEvent>)) {
+        const int eventType = EventType<TEvent>::GetId();
+        const Handler handler = CreateHandler<EventSpan<TEvent>>(ownerInstance, callbackFunction, true);
+        GetHandlerList(eventType).handlers.push_back(handler);
+        return EventSubscription(this, eventType, handler.id, -1);
     }
 
+    // Scoped handlers only get events about an entity they are interested
+    // in, found through an index by entity id instead of every handler
+    // checking every event. Entity ids are reused, so the handlers are
+    // dropped when the entity is destroyed if the bus is a removal listener
+    // of the registry.
     template <typename TOwner, typename TEvent>
-    void SubscribeEvent(TOwner* ownerInstance, void (TOwner::*callbackFunction)(TEvent&)) {
-        if (!subscribers_[typeid(TEvent)].get()) {
-            subscribers_[typeid(TEvent)] = std::make_unique<HandlerList>();
+    [[nodiscard]] EventSubscription SubscribeEntityEvent(Entity entity, TOwner* ownerInstance, void (TOwner::*callbackFunction)(const TEvent&)) {
+        static_assert(IsEntityEvent<TEvent>::value, "Only events about entities can be scoped");
+
+        const int eventType = EventType<TEvent>::GetId();
+        const int entityId = entity.GetId();
+        auto& list = GetHandlerList(eventType);
+        if (entityId >= static_cast<int>(list.entityHandlers.size())) {
+            list.entityHandlers.resize(entityId + 1);
         }
-        auto subscriber = std::make_unique<EventCallback<TOwner, TEvent>>(ownerInstance, callbackFunction);
-        subscribers_[typeid(TEvent)]->push_back(std::move(subscriber));
+
+        const Handler handler = CreateHandler<TEvent>(ownerInstance, callbackFunction, false);
+        list.entityHandlers[entityId].push_back(handler);
+        list.entityHandlerCount++;
+        return EventSubscription(this, eventType, handler.id, entityId);
+    }
+
+    template <typename TOwner, typename TEvent>
+    [[nodiscard]] EventSubscription SubscribeGroupEvent(const std::string& group, TOwner* ownerInstance, void (TOwner::*callbackFunction)(const TEvent&)) {
+        return AddFilteredHandler(ownerInstance, callbackFunction, group, Signature());
     }
 
+    // Only events about an entity with all of TComponents reach the handler.
+    template <typename... TComponents, typename TOwner, typename TEvent>
+    [[nodiscard]] EventSubscription SubscribeComponentEvent(TOwner* ownerInstance, void (TOwner::*callbackFunction)(const TEvent&)) {
+        Signature signature;
+        (signature.set(Component<TComponents>::GetId()), ...);
+        return AddFilteredHandler(ownerInstance, callbackFunction, "", signature);
+    }
+
+    // Drops the entity's scoped handlers, so an entity that later gets the
+    // same id does not inherit them. Their subscriptions then remove nothing.
+    void OnEntityDestroyed(Entity entity) override {
+        const int entityId = entity.GetId();
+
+        for (auto& list : handlers_) {
+            if (entityId >= static_cast<int>(list.entityHandlers.size())) {
+                continue;
+            }
+
+            auto& handlers = list.entityHandlers[entityId];
+            for (auto& handler : handlers) {
+                if (!IsRemoved(handler)) {
+                    list.entityHandlerCount--;
+                    handler.id = kRemovedHandler;
+                }
+            }
+
+            if (dispatch_depth_ > 0) {
+                has_removed_handlers_ = has_removed_handlers_ || !handlers.empty();
+            } else {
+                handlers.clear();
+            }
+        }
+    }
+
+    void Unsubscribe(int eventType, int id, int entityId) {
+        auto& list = handlers_[eventType];
+        const auto getHandler = [](Handler& handler) -> Handler& { return handler; };
+
+        if (entityId != -1) {
+            if (RemoveHandler(list.entityHandlers[entityId], id, getHandler)) {
+                list.entityHandlerCount--;
+            }
+            return;
+        }
+
+        if (!RemoveHandler(list.handlers, id, getHandler)) {
+            RemoveHandler(list.filteredHandlers, id, [](FilteredHandler& filtered) -> Handler& { return filtered.handler; });
+        }
+    }
+
+    // The event is built once and every handler gets the same instance.
+    // Handlers subscribed while it is dispatched first see the next event.
     template <typename TEvent, typename... TArgs>
     void EmitEvent(TArgs&&... args) {
-        auto handlers = subscribers_[typeid(TEvent)].get();
+        const int eventType = EventType<TEvent>::GetId();
+        if (!HasHandlers(eventType)) {
+            return;
+        }
+
+        const TEvent event(std::forward<TArgs>(args)...);
+        DispatchEvent(eventType, event);
+    }
 
-        if (handlers) {
-            for (auto it = handlers->begin(); it != handlers->end(); it++) {
-                auto handler = it->get();
-                TEvent event(std::forward<TArgs>(args)...);
-                handler->Execute(event);
+    // Queues the event until its type is flushed. Events nobody listens to
+    // are dropped right away.
+    template <typename TEvent, typename... TArgs>
+    void QueueEvent(TArgs&&... args) {
+        if (!HasHandlers(EventType<TEvent>::GetId())) {
+            return;
+        }
+
+        GetQueue<TEvent>().Push(std::forward<TArgs>(args)...);
+    }
+
+    // Sets up laneCount lanes for the event type. Events published on them are
+    // delivered after the ones queued with QueueEvent, and dropped at the
+    // flush if nobody listens by then.
+    template <typename TEvent>
+    EventPublisher<TEvent> GetPublisher(int laneCount) {
+        auto& queue = GetQueue<TEvent>();
+        queue.SetLaneCount(laneCount);
+        return EventPublisher<TEvent>(queue);
+    }
+
+    // Sends the queued events of one type: each to the single event handlers,
+    // then all of them to the batch handlers. Events queued by the handlers
+    // wait for the next flush.
+    template <typename TEvent>
+    void FlushEvents() {
+        const int eventType = EventType<TEvent>::GetId();
+        if (eventType < static_cast<int>(queues_.size()) && queues_[eventType]) {
+            queues_[eventType]->Flush(*this);
+        }
+    }
+
+    // Flushes every queue, in the order the event types were first used.
+    void FlushEvents() {
+        for (size_t i = 0; i < queues_.size(); i++) {
+            if (queues_[i]) {
+                queues_[i]->Flush(*this);
             }
         }
     }
-};
\ No newline at end of file
+};
+
+template <typename TEvent>
+void EventQueue<TEvent>::Flush(EventBus& eventBus) {
+    if (is_flushing_) {
+        return;
+    }
+
+    MergeLanes();
+    if (pending_.empty()) {
+        return;
+    }
+
+    const int eventType = EventType<TEvent>::GetId();
+
+    is_flushing_ = true;
+    std::swap(pending_, flushing_);
+
+    if (eventBus.HasEventHandlers(eventType)) {
+        for (const auto& event : flushing_) {
+            eventBus.DispatchEvent(eventType, event);
+        }
+    }
+
+    const EventSpan<TEvent> events(flushing_.data(), flushing_.size());
+    eventBus.Dispatch(eventType, true, &events);
+
+    flushing_.clear();
+    is_flushing_ = false;
+}
+
+inline void EventSubscription::Unsubscribe() {
+    if (event_bus_ != nullptr) {
+        event_bus_->Unsubscribe(event_type_, id_, entity_id_);
+        event_bus_ = nullptr;
+    }
+}
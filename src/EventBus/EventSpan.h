@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * A read only view of a batch of queued events of one type, in the order they
+ * were queued. Only valid during the call it is passed to.
+ */
+template <typename TEvent>
+class EventSpan {
+   private:
+    const TEvent* data_;
+    size_t size_;
+
+   public:
+    EventSpan(const TEvent* data, size_t size) : data_(data), size_(size) {
+    }
+
+    const TEvent* begin() const {
+        return data_;
+    }
+
+    const TEvent* end() const {
+        return data_ + size_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    const TEvent& operator[](size_t index) const {
+        return data_[index];
+    }
+};
@@ -6,4 +6,13 @@ class CollisionEvent : public Event {
     Entity entityB;
 
     CollisionEvent(Entity a, Entity b) : entityA(a), entityB(b) {}
+
+    // Lets handlers subscribe to the collisions of just some entities.
+    int GetEntityCount() const {
+        return 2;
+    }
+
+    Entity GetEntity(int index) const {
+        return index == 0 ? entityA : entityB;
+    }
 };
\ No newline at end of file
@@ -53,7 +53,11 @@ void ECSLoader::LoadEntity(sol::table entityTable, const std::unique_ptr<Registr
             newEntity.AddComponent<RigidBodyComponent>(
                 glm::vec2(
                     entityTable["components"]["rigidbody"]["velocity"]["x"].get_or(0.0),
-                    entityTable["components"]["rigidbody"]["velocity"]["y"].get_or(0.0)));
+                    entityTable["components"]["rigidbody"]["velocity"]["y"].get_or(0.0)),
+                entityTable["components"]["rigidbody"]["mass"].get_or(0.0f),
+                entityTable["components"]["rigidbody"]["restitution"].get_or(0.0f),
+                entityTable["components"]["rigidbody"]["friction"].get_or(0.2f),
+                entityTable["components"]["rigidbody"]["linear_damping"].get_or(0.0f));
         }
 
         // Sprite
@@ -102,7 +106,9 @@ void ECSLoader::LoadEntity(sol::table entityTable, const std::unique_ptr<Registr
                 entityTable["components"]["boxcollider"]["height"],
                 glm::vec2(
                     entityTable["components"]["boxcollider"]["offset"]["x"].get_or(0),
-                    entityTable["components"]["boxcollider"]["offset"]["y"].get_or(0)));
+                    entityTable["components"]["boxcollider"]["offset"]["y"].get_or(0)),
+                entityTable["components"]["boxcollider"]["category"].get_or(GetDefaultCollisionCategory(newEntity)),
+                entityTable["components"]["boxcollider"]["collides_with"].get_or(kCollideWithAll));
         }
 
         // Health
@@ -139,9 +145,17 @@ void ECSLoader::LoadEntity(sol::table entityTable, const std::unique_ptr<Registr
         }
 
         sol::optional<sol::table> onUpdateScript = entityTable["components"]["on_update_script"];
-        if (onUpdateScript != sol::nullopt) {
-            sol::function scriptFunction = entityTable["components"]["on_update_script"][0];
-            newEntity.AddComponent<ScriptComponent>(scriptFunction);
+        sol::optional<sol::table> onCollisionScript = entityTable["components"]["on_collision_script"];
+        if (onUpdateScript != sol::nullopt || onCollisionScript != sol::nullopt) {
+            sol::function scriptFunction = sol::lua_nil;
+            sol::function collisionFunction = sol::lua_nil;
+            if (onUpdateScript != sol::nullopt) {
+                scriptFunction = entityTable["components"]["on_update_script"][0];
+            }
+            if (onCollisionScript != sol::nullopt) {
+                collisionFunction = entityTable["components"]["on_collision_script"][0];
+            }
+            newEntity.AddComponent<ScriptComponent>(scriptFunction, collisionFunction);
         }
 
         sol::optional<sol::table> button = entityTable["components"]["button"];
@@ -160,6 +174,19 @@ void ECSLoader::LoadEntity(sol::table entityTable, const std::unique_ptr<Registr
     }
 }
 
+uint32_t ECSLoader::GetDefaultCollisionCategory(Entity entity) {
+    if (entity.HasTag("player")) {
+        return LAYER_PLAYER;
+    }
+    if (entity.InGroup("enemies")) {
+        return LAYER_ENEMIES;
+    }
+    if (entity.InGroup("obstacles")) {
+        return LAYER_OBSTACLES;
+    }
+    return LAYER_DEFAULT;
+}
+
 void ECSLoader::LoadAsset(sol::table assetTable, const std::unique_ptr<AssetManager>& assetManager, SDL_Renderer* renderer) {
     std::string assetType = assetTable["type"];
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <sol/sol.hpp>
 
 #include "../AssetManager/AssetManager.h"
@@ -12,4 +13,8 @@ class ECSLoader {
 
     void LoadEntity(sol::table entityTable, const std::unique_ptr<Registry>& registry);
     void LoadAsset(sol::table assetTable, const std::unique_ptr<AssetManager>& assetManager, SDL_Renderer* renderer);
+
+   private:
+    // Picks a collision layer from the tag and group when the level gives none.
+    uint32_t GetDefaultCollisionCategory(Entity entity);
 };
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "FrameScheduler.h"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+
+#include "../General/Profiler.h"
+
+// The weight of the newest part in the running average of part times.
+const double kPartTimeSmoothing = 0.1;
+
+FrameScheduler::FrameScheduler()
+    : systems_(),
+      frequency_(SDL_GetPerformanceFrequency()),
+      frame_start_(SDL_GetPerformanceCounter()),
+      budget_(0.0) {
+}
+
+void FrameScheduler::AddDeferredSystem(System& system, const char* name, int priority, int maxStaleFrames, int partCount) {
+    partCount = std::max(partCount, 1);
+    DeferredSystem deferred = {&system, name, priority, std::max(maxStaleFrames, 0), partCount, 0, 0, std::vector<int>(partCount, 0), 0.0};
+
+    auto it = std::find_if(systems_.begin(), systems_.end(), [priority](const DeferredSystem& other) {
+        return other.priority < priority;
+    });
+    systems_.insert(it, deferred);
+}
+
+void FrameScheduler::SetBudget(double seconds) {
+    budget_ = std::max(seconds, 0.0);
+}
+
+void FrameScheduler::BeginFrame() {
+    frame_start_ = SDL_GetPerformanceCounter();
+}
+
+double FrameScheduler::GetElapsedSeconds() const {
+    return static_cast<double>(SDL_GetPerformanceCounter() - frame_start_) / frequency_;
+}
+
+void FrameScheduler::RunDeferredSystems() {
+    for (auto& deferred : systems_) {
+        for (int& age : deferred.partAges) {
+            age++;
+        }
+        deferred.partsRun = 0;
+
+        while (deferred.partsRun < deferred.partCount) {
+            // Parts run in turn, so the next part is always the oldest.
+            const bool isForced = deferred.partAges[deferred.nextPart] > deferred.maxStaleFrames;
+
+            if (!isForced && GetElapsedSeconds() + deferred.partSeconds > budget_) {
+                break;
+            }
+
+            const uint64_t start = SDL_GetPerformanceCounter();
+            {
+                ProfileScope scope(deferred.name);
+                deferred.system->UpdatePart(deferred.nextPart, deferred.partCount);
+            }
+            const double seconds = static_cast<double>(SDL_GetPerformanceCounter() - start) / frequency_;
+
+            deferred.partSeconds += (seconds - deferred.partSeconds) * kPartTimeSmoothing;
+            deferred.partAges[deferred.nextPart] = 0;
+            deferred.nextPart = (deferred.nextPart + 1) % deferred.partCount;
+            deferred.partsRun++;
+        }
+    }
+}
+
+std::vector<DeferredSystemStats> FrameScheduler::GetStats() const {
+    std::vector<DeferredSystemStats> stats;
+
+    for (const auto& deferred : systems_) {
+        const int staleFrames = *std::max_element(deferred.partAges.begin(), deferred.partAges.end());
+        stats.push_back({deferred.name, deferred.partCount, deferred.partsRun, staleFrames, deferred.partSeconds});
+    }
+
+    return stats;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../ECS/ECS.h"
+
+struct DeferredSystemStats {
+    std::string name;
+    int partCount;
+    int partsRun;
+    // The most frames any part has gone without running.
+    int staleFrames;
+    double partSeconds;
+};
+
+/**
+ * Runs the systems that can fall behind in whatever time the frame has left.
+ * Each deferred system is split into parts. With time to spare every part
+ * runs and the system is current. When the frame is short, systems run a part
+ * at a time in priority order while the budget lasts, and any part that has
+ * gone its system's maximum number of frames without running runs regardless.
+ * The limit holds for each part, so it bounds how stale any entity gets.
+ */
+class FrameScheduler {
+   private:
+    struct DeferredSystem {
+        System* system;
+        // A string literal, so the profiler can keep it.
+        const char* name;
+        int priority;
+        int maxStaleFrames;
+        int partCount;
+        int nextPart;
+        int partsRun;
+        // Frames since each part last ran, counting the current one.
+        std::vector<int> partAges;
+        // A running average of how long one part takes.
+        double partSeconds;
+    };
+
+    std::vector<DeferredSystem> systems_;
+    uint64_t frequency_;
+    uint64_t frame_start_;
+    double budget_;
+
+   public:
+    FrameScheduler();
+    ~FrameScheduler() = default;
+
+    // Higher priorities get the budget first. The system's UpdatePart is
+    // called with parts 0 to partCount - 1 in turn. No part is skipped for
+    // more than maxStaleFrames frames in a row.
+    void AddDeferredSystem(System& system, const char* name, int priority, int maxStaleFrames, int partCount);
+
+    // Seconds from the start of the frame that deferred work may run until.
+    void SetBudget(double seconds);
+
+    double GetBudget() const {
+        return budget_;
+    }
+
+    // Marks the start of the frame the budget counts from.
+    void BeginFrame();
+
+    double GetElapsedSeconds() const;
+
+    void RunDeferredSystems();
+
+    std::vector<DeferredSystemStats> GetStats() const;
+};
@@ -6,6 +6,8 @@
 #include <imgui/imgui_impl_sdl2.h>
 #include <imgui/imgui_impl_sdlrenderer2.h>
 
+#include <algorithm>
+#include <cmath>
 #include <glm/glm.hpp>
 #include <iostream>
 #include <memory>
@@ -14,26 +16,33 @@
 #include <vector>
 
 #include "../ECS/ECS.h"
+#include "../Events/CollisionEvent.h"
 #include "../Events/KeyInputEvent.h"
+#include "../Events/MouseInputEvent.h"
 #include "../General/Logger.h"
+#include "../General/MemoryTracker.h"
+#include "../General/PerfCounters.h"
+#include "../General/Profiler.h"
 #include "../MapEditor/MapEditor.h"
 #include "../Renderer/RenderQueue.h"
 #include "../Renderer/Renderer.h"
 #include "../Systems/AnimationSystem.h"
+#include "../Systems/BulletSystem.h"
 #include "../Systems/CameraFollowSystem.h"
 #include "../Systems/CollisionSystem.h"
-#include "../Systems/DamageSystem.h"
 #include "../Systems/DisplayHealthSystem.h"
 #include "../Systems/DrawColliderSystem.h"
+#include "../Systems/InterpolationSystem.h"
 #include "../Systems/KeyboardControlSystem.h"
 #include "../Systems/MovementSystem.h"
+#include "../Systems/PhysicsSystem.h"
 #include "../Systems/ProjectileEmitSystem.h"
-#include "../Systems/ProjectileLifecycleSystem.h"
 #include "../Systems/RenderGUISystem.h"
 #include "../Systems/RenderPrimitiveSystem.h"
 #include "../Systems/RenderSpriteSystem.h"
 #include "../Systems/RenderTextSystem.h"
 #include "../Systems/ScriptSystem.h"
+#include "../Systems/SpatialIndexSystem.h"
 #include "../Systems/UIButtonSystem.h"
 #include "./LevelLoader.h"
 
@@ -45,12 +54,23 @@ int Game::mapHeight;
 Game::Game() : window_(nullptr),
                sdl_renderer_(nullptr),
                camera_(),
+               is_headless_(false),
                show_colliders_(false),
-               milliseconds_previous_frame_(),
+               clock_(),
+               frame_pacer_(),
+               frame_scheduler_(),
+               timers_(),
+               tick_delta_time_(1.0 / kDefaultTickRate),
+               max_ticks_per_frame_(kDefaultMaxTicksPerFrame),
+               tick_accumulator_(0.0),
+               simulation_time_(0.0),
+               interpolation_alpha_(0.0f),
+               lua(sol::default_at_panic, MemoryTracker::LuaAllocate),
                render_queue_() {
     registry_ = std::make_unique<Registry>();
     asset_manager_ = std::make_unique<AssetManager>();
     event_bus_ = std::make_unique<EventBus>();
+    registry_->AddRemovalListener(event_bus_.get());
     renderer_ = std::make_unique<Renderer>();
     Logger::Info("Game Constructor called.");
 }
@@ -59,6 +79,19 @@ Game::~Game() {
     Logger::Info("Game Destructor called.");
 }
 
+void Game::SetTickRate(int ticksPerSecond) {
+    if (ticksPerSecond <= 0) {
+        Logger::Error("Tick rate must be positive, got: " + std::to_string(ticksPerSecond));
+        return;
+    }
+
+    tick_delta_time_ = 1.0 / ticksPerSecond;
+}
+
+void Game::SetMaxTicksPerFrame(int maxTicks) {
+    max_ticks_per_frame_ = std::max(maxTicks, 1);
+}
+
 void Game::Initialize() {
     auto result = SDL_Init(SDL_INIT_EVERYTHING);
 
@@ -108,11 +141,34 @@ void Game::Initialize() {
     camera_.h = windowHeight;
 
     SDL_SetRenderDrawColor(sdl_renderer_, 21, 21, 21, 255);
+    frame_pacer_.Initialize(sdl_renderer_, kFps, FramePacingMode::PACING_SLEEP_SPIN);
+
+    s_is_running_ = true;
+}
+
+void Game::InitializeHeadless() {
+    is_headless_ = true;
+
+    if (SDL_Init(SDL_INIT_TIMER) != 0) {
+        Logger::Error("SDL_Init Error: " + std::string(SDL_GetError()));
+        return;
+    }
+
+    windowWidth = kHeadlessWindowWidth;
+    windowHeight = kHeadlessWindowHeight;
+    camera_ = {0, 0, windowWidth, windowHeight};
 
     s_is_running_ = true;
 }
 
 void Game::Destroy() {
+    PerfCounters::Close();
+
+    if (is_headless_) {
+        SDL_Quit();
+        return;
+    }
+
     ImGui_ImplSDLRenderer2_Shutdown();
     ImGui_ImplSDL2_Shutdown();
     ImGui::DestroyContext();
@@ -123,37 +179,125 @@ void Game::Destroy() {
 
 void Game::Run(bool isMapEditor) {
     Setup(isMapEditor);
+    // Loading is not part of the first frame.
+    clock_.Reset();
+    tick_accumulator_ = 0.0;
 
     while (s_is_running_) {
+        Profiler::BeginFrame();
+        MemoryTracker::BeginFrame();
         ProcessInput();
         Update();
         Render();
+        MemoryTracker::EndFrame();
+        Profiler::EndFrame();
+    }
+}
+
+void Game::RunHeadless(int maxTicks, double maxSeconds) {
+    Setup(false);
+
+    if (maxSeconds > 0.0) {
+        const int durationTicks = static_cast<int>(std::ceil(maxSeconds / tick_delta_time_));
+        maxTicks = maxTicks > 0 ? std::min(maxTicks, durationTicks) : durationTicks;
+    }
+
+    // Every tick is a whole step of game time, however long it really took.
+    clock_.SetManualStep(tick_delta_time_);
+    clock_.Reset();
+
+    std::vector<double> tickSeconds;
+    tickSeconds.reserve(maxTicks > 0 ? maxTicks : 0);
+    PerfCounters::Reset();
+    const uint64_t frequency = SDL_GetPerformanceFrequency();
+    const uint64_t runStart = SDL_GetPerformanceCounter();
+
+    while (s_is_running_ && (maxTicks <= 0 || static_cast<int>(tickSeconds.size()) < maxTicks)) {
+        const uint64_t tickStart = SDL_GetPerformanceCounter();
+        Profiler::BeginFrame();
+        MemoryTracker::BeginFrame();
+        clock_.Tick();
+        Tick();
+        MemoryTracker::EndFrame();
+        Profiler::EndFrame();
+        tickSeconds.push_back(static_cast<double>(SDL_GetPerformanceCounter() - tickStart) / frequency);
+    }
+
+    const double wallSeconds = static_cast<double>(SDL_GetPerformanceCounter() - runStart) / frequency;
+    const int ticks = static_cast<int>(tickSeconds.size());
+    // The summary is not part of any tick, and its own allocations are not
+    // counted against it.
+    const bool isCheckingAllocations = MemoryTracker::IsExpectingNoAllocations();
+    MemoryTracker::StopExpectingNoAllocations();
+
+    if (ticks == 0) {
+        Logger::Log("Headless run finished without running a tick.");
+        return;
+    }
+
+    std::sort(tickSeconds.begin(), tickSeconds.end());
+    double totalTickSeconds = 0.0;
+    for (double seconds : tickSeconds) {
+        totalTickSeconds += seconds;
+    }
+    const double p99 = tickSeconds[std::min(ticks - 1, static_cast<int>(std::ceil(ticks * 0.99)) - 1)];
+
+    Logger::Log("Headless run finished.");
+    Logger::Log("Ticks: " + std::to_string(ticks) + ", game time: " + std::to_string(simulation_time_) + " s, wall time: " + std::to_string(wallSeconds) + " s, " + std::to_string(simulation_time_ / wallSeconds) + "x real time");
+    Logger::Log("Tick ms average: " + std::to_string(totalTickSeconds / ticks * 1000.0) + ", p99: " + std::to_string(p99 * 1000.0) + ", max: " + std::to_string(tickSeconds.back() * 1000.0));
+    Logger::Log("Entities: " + std::to_string(registry_->GetEntityCount()) + ", bullets: " + std::to_string(registry_->GetSystem<BulletSystem>().GetBullets().GetCount()));
+
+    if (PerfCounters::IsOpen()) {
+        Logger::Log("Hardware counters per scope (cycles per call, instructions per cycle, cache and branch misses per entity):");
+        for (const auto& scope : PerfCounters::GetStats()) {
+            Logger::Log("  " + scope.name + ": " + std::to_string(static_cast<uint64_t>(scope.cyclesPerCall)) + ", IPC " + std::to_string(scope.instructionsPerCycle) +
+                        ", cache misses " + std::to_string(scope.cacheMissesPerItem) + ", branch misses " + std::to_string(scope.branchMissesPerItem));
+        }
+    }
+
+    if (isCheckingAllocations) {
+        Logger::Log("Unexpected allocations: " + std::to_string(MemoryTracker::GetUnexpectedAllocationCount()) + " at " + std::to_string(MemoryTracker::GetAllocationSiteCount()) + " sites");
     }
 }
 
 void Game::Setup(bool isMapEditor) {
     registry_->AddSystem<CameraFollowSystem>();
-    registry_->AddSystem<ProjectileEmitSystem>();
-    registry_->AddSystem<ProjectileLifecycleSystem>();
-    registry_->AddSystem<DisplayHealthSystem>();
-    registry_->AddSystem<DamageSystem>();
+    registry_->AddSystem<DisplayHealthSystem>(*registry_);
     registry_->AddSystem<MovementSystem>();
+    registry_->AddSystem<PhysicsSystem>(registry_->GetSystem<MovementSystem>().GetTileGrid());
+    registry_->AddSystem<BulletSystem>(registry_->GetSystem<MovementSystem>().GetTileGrid());
+    registry_->AddSystem<ProjectileEmitSystem>(registry_->GetSystem<BulletSystem>().GetBullets(), timers_);
 
     registry_->AddSystem<RenderSpriteSystem>();
     registry_->AddSystem<RenderTextSystem>();
     registry_->AddSystem<RenderPrimitiveSystem>();
     registry_->AddSystem<RenderGUISystem>();
-    registry_->AddSystem<AnimationSystem>();
+    registry_->AddSystem<AnimationSystem>(clock_);
     registry_->AddSystem<CollisionSystem>();
     registry_->AddSystem<DrawColliderSystem>();
+    registry_->AddSystem<InterpolationSystem>();
     registry_->AddSystem<KeyboardControlSystem>();
     registry_->AddSystem<ScriptSystem>();
-    registry_->AddSystem<UIButtonSystem>();
+    registry_->AddSystem<SpatialIndexSystem>();
+    registry_->AddSystem<UIButtonSystem>(registry_->GetSystem<SpatialIndexSystem>());
+
+    // Animation and health labels can lag a few frames when time is short.
+    frame_scheduler_.SetBudget(kDeferredBudgetSeconds);
+    frame_scheduler_.AddDeferredSystem(registry_->GetSystem<AnimationSystem>(), "Animation", 1, 2, 4);
+    frame_scheduler_.AddDeferredSystem(registry_->GetSystem<DisplayHealthSystem>(), "Health labels", 0, 4, 4);
+
+    // Subscriptions last until their owner is destroyed.
+    registry_->GetSystem<KeyboardControlSystem>().SubscribeToEvents(event_bus_);
+    registry_->GetSystem<ProjectileEmitSystem>().SubscribeToEvents(event_bus_);
+    registry_->GetSystem<UIButtonSystem>().SubscribeToEvents(event_bus_);
+    registry_->GetSystem<ScriptSystem>().SubscribeToEvents(event_bus_);
+    SubscribeToEvents(event_bus_);
 
     lua.open_libraries(sol::lib::base, sol::lib::math, sol::lib::io);
     lua["game_window_width"] = windowWidth;
     lua["game_window_height"] = windowHeight;
     registry_->GetSystem<ScriptSystem>().CreateLuaBindings(lua);
+    registry_->GetSystem<SpatialIndexSystem>().CreateLuaBindings(lua);
 
     if (isMapEditor) {
         MapEditor editor;
@@ -165,6 +309,7 @@ void Game::Setup(bool isMapEditor) {
 }
 
 void Game::ProcessInput() {
+    PROFILE_SCOPE("Input");
     SDL_Event event;
 
     while (SDL_PollEvent(&event)) {
@@ -184,13 +329,13 @@ void Game::ProcessInput() {
             case SDL_KEYDOWN:
             case SDL_KEYUP: {
                 KeyInputEvent keyInputEvent = GetKeyInputEvent(&event.key);
-                event_bus_->EmitEvent<KeyInputEvent>(keyInputEvent);
+                event_bus_->QueueEvent<KeyInputEvent>(keyInputEvent);
                 break;
             }
             case SDL_MOUSEBUTTONDOWN:
             case SDL_MOUSEBUTTONUP: {
                 SDL_MouseButtonEvent mouseButtonEvent = event.button;
-                event_bus_->EmitEvent<MouseInputEvent>(mouseButtonEvent);
+                event_bus_->QueueEvent<MouseInputEvent>(mouseButtonEvent);
                 break;
             }
             default:
@@ -200,66 +345,166 @@ void Game::ProcessInput() {
 }
 
 void Game::Update() {
-    // If we are too fast, waste some time until we reach the frame time
-    int timeToWait = kMillisecondsPerFrame - (SDL_GetTicks() - milliseconds_previous_frame_);
-    if (timeToWait > 0 && timeToWait <= kMillisecondsPerFrame) {
-        SDL_Delay(timeToWait);
+    {
+        PROFILE_SCOPE("Frame wait");
+        frame_pacer_.WaitForNextFrame();
     }
+    frame_scheduler_.BeginFrame();
 
-    // Subscribe to events
-    event_bus_->Reset();
-    registry_->GetSystem<DamageSystem>().SubscribeToEvents(event_bus_);
-    registry_->GetSystem<KeyboardControlSystem>().SubscribeToEvents(event_bus_);
-    registry_->GetSystem<ProjectileEmitSystem>().SubscribeToEvents(event_bus_);
-    registry_->GetSystem<MovementSystem>().SubscribeToEvents(event_bus_);
-    registry_->GetSystem<UIButtonSystem>().SubscribeToEvents(event_bus_);
-    registry_->GetSystem<ScriptSystem>().SubscribeToEvents(event_bus_);
-    SubscribeToEvents(event_bus_);
+    // Every system reads this frame's time from the clock.
+    clock_.Tick();
+
+    // Input queued while polling is handled in one batch before anything moves.
+    {
+        PROFILE_SCOPE("Input events");
+        event_bus_->FlushEvents<KeyInputEvent>();
+        event_bus_->FlushEvents<MouseInputEvent>();
+    }
+
+    tick_accumulator_ += clock_.GetDeltaTime();
+    int ticks = 0;
+
+    while (tick_accumulator_ >= tick_delta_time_ && ticks < max_ticks_per_frame_) {
+        Tick();
+        tick_accumulator_ -= tick_delta_time_;
+        ticks++;
+    }
+
+    if (tick_accumulator_ >= tick_delta_time_) {
+        tick_accumulator_ = std::fmod(tick_accumulator_, tick_delta_time_);
+    }
+
+    interpolation_alpha_ = static_cast<float>(tick_accumulator_ / tick_delta_time_);
+
+    // Presentation follows the frame rather than the ticks.
+    {
+        PROFILE_SCOPE("Camera follow");
+        registry_->GetSystem<CameraFollowSystem>().Update(camera_, interpolation_alpha_);
+    }
+    {
+        PROFILE_SCOPE("Deferred systems");
+        frame_scheduler_.RunDeferredSystems();
+    }
+}
+
+void Game::Tick() {
+    PROFILE_SCOPE("Tick");
+    const double deltaTime = tick_delta_time_;
+    simulation_time_ += deltaTime;
 
-    // Calculate delta time
-    double deltaTime = (SDL_GetTicks() - milliseconds_previous_frame_) / 1000.0;
-
-    milliseconds_previous_frame_ = SDL_GetTicks();
-
-    registry_->GetSystem<MovementSystem>().Update(deltaTime);
-    registry_->GetSystem<AnimationSystem>().Update();
-    registry_->GetSystem<CollisionSystem>().Update(event_bus_);
-    registry_->GetSystem<DamageSystem>().Update();
-    registry_->GetSystem<KeyboardControlSystem>().Update();
-    registry_->GetSystem<CameraFollowSystem>().Update(camera_);
-    registry_->GetSystem<ProjectileEmitSystem>().Update(registry_);
-    registry_->GetSystem<ProjectileLifecycleSystem>().Update();
-    registry_->GetSystem<DisplayHealthSystem>().Update(registry_);
-    registry_->GetSystem<ScriptSystem>().Update(deltaTime, SDL_GetTicks());
-    registry_->Update();
+    {
+        PROFILE_SCOPE("Timers");
+        timers_.Advance(simulation_time_);
+    }
+    {
+        auto& interpolationSystem = registry_->GetSystem<InterpolationSystem>();
+        PROFILE_SCOPE_ITEMS("Interpolation", interpolationSystem.GetEntityCount());
+        interpolationSystem.SavePreviousTransforms();
+    }
+    {
+        auto& movementSystem = registry_->GetSystem<MovementSystem>();
+        PROFILE_SCOPE_ITEMS("Movement", movementSystem.GetEntityCount());
+        movementSystem.Update(deltaTime);
+    }
+    {
+        auto& spatialIndexSystem = registry_->GetSystem<SpatialIndexSystem>();
+        PROFILE_SCOPE_ITEMS("Spatial index", spatialIndexSystem.GetEntityCount());
+        spatialIndexSystem.Update();
+    }
+    {
+        auto& collisionSystem = registry_->GetSystem<CollisionSystem>();
+        PROFILE_SCOPE_ITEMS("Collision", collisionSystem.GetEntityCount());
+        collisionSystem.Update(event_bus_);
+    }
+    {
+        PROFILE_SCOPE("Collision events");
+        event_bus_->FlushEvents<CollisionEvent>();
+    }
+    const auto& contacts = registry_->GetSystem<CollisionSystem>().GetContacts();
+    {
+        auto& physicsSystem = registry_->GetSystem<PhysicsSystem>();
+        PROFILE_SCOPE_ITEMS("Physics", physicsSystem.GetEntityCount());
+        physicsSystem.Update(deltaTime, contacts);
+    }
+    {
+        PROFILE_SCOPE("Resolve contacts");
+        registry_->GetSystem<MovementSystem>().ResolveContacts(contacts);
+    }
+    {
+        auto& keyboardControlSystem = registry_->GetSystem<KeyboardControlSystem>();
+        PROFILE_SCOPE_ITEMS("Keyboard control", keyboardControlSystem.GetEntityCount());
+        keyboardControlSystem.Update();
+    }
+    {
+        auto& projectileEmitSystem = registry_->GetSystem<ProjectileEmitSystem>();
+        PROFILE_SCOPE_ITEMS("Projectile emit", projectileEmitSystem.GetEntityCount());
+        projectileEmitSystem.Update();
+    }
+    {
+        // Bullets are not entities, so they are the items here.
+        auto& bulletSystem = registry_->GetSystem<BulletSystem>();
+        PROFILE_SCOPE_ITEMS("Bullets", bulletSystem.GetBullets().GetCount());
+        bulletSystem.Update(deltaTime);
+    }
+    {
+        auto& scriptSystem = registry_->GetSystem<ScriptSystem>();
+        PROFILE_SCOPE_ITEMS("Scripts", scriptSystem.GetEntityCount());
+        scriptSystem.Update(deltaTime, simulation_time_ * 1000.0);
+    }
+    {
+        PROFILE_SCOPE("Registry");
+        registry_->Update();
+    }
 }
 
 void Game::Render() {
+    PROFILE_SCOPE("Render");
     SDL_SetRenderDrawColor(sdl_renderer_, 21, 21, 21, 255);
     SDL_RenderClear(sdl_renderer_);
 
     // Render the game
-    render_queue_.Clear();
-    registry_->GetSystem<RenderSpriteSystem>().Update(render_queue_, camera_);
-    registry_->GetSystem<RenderTextSystem>().Update(render_queue_);
-    registry_->GetSystem<RenderPrimitiveSystem>().Update(render_queue_);
-
-    render_queue_.Sort();
-    renderer_->Render(render_queue_, sdl_renderer_, camera_, asset_manager_);
+    {
+        PROFILE_SCOPE("Render queue");
+        render_queue_.Clear();
+        registry_->GetSystem<DisplayHealthSystem>().FollowEntities(interpolation_alpha_);
+        registry_->GetSystem<RenderSpriteSystem>().Update(render_queue_, camera_, interpolation_alpha_);
+        registry_->GetSystem<RenderTextSystem>().Update(render_queue_);
+        registry_->GetSystem<RenderPrimitiveSystem>().Update(render_queue_);
+        render_queue_.Sort();
+    }
+    renderer_->Render(render_queue_, sdl_renderer_, camera_, asset_manager_, interpolation_alpha_, 0, kBulletRenderLayer + 1);
+    {
+        PROFILE_SCOPE("Bullet render");
+        registry_->GetSystem<BulletSystem>().Render(sdl_renderer_, camera_, asset_manager_, interpolation_alpha_, tick_delta_time_);
+    }
+    renderer_->Render(render_queue_, sdl_renderer_, camera_, asset_manager_, interpolation_alpha_, kBulletRenderLayer + 1);
 
     if (show_colliders_) {
+        PROFILE_SCOPE("Debug overlay");
         registry_->GetSystem<DrawColliderSystem>().Update(sdl_renderer_, camera_);
-        registry_->GetSystem<RenderGUISystem>().Update(sdl_renderer_, registry_);
+        std::vector<MemoryUsage> memoryUsage;
+        GetMemoryUsage(memoryUsage);
+        registry_->GetSystem<RenderGUISystem>().Update(sdl_renderer_, registry_, frame_pacer_, frame_scheduler_, memoryUsage);
     }
 
-    SDL_RenderPresent(sdl_renderer_);
+    {
+        PROFILE_SCOPE("Present");
+        SDL_RenderPresent(sdl_renderer_);
+    }
+}
+
+void Game::GetMemoryUsage(std::vector<MemoryUsage>& usage) const {
+    registry_->GetMemoryUsage(usage);
+    asset_manager_->GetMemoryUsage(usage);
+    usage.push_back(registry_->GetSystem<BulletSystem>().GetBullets().GetMemoryUsage());
+    usage.push_back({"Lua heap", 0, MemoryTracker::GetLuaBytes(), MemoryTracker::GetLuaBytes(), 0});
 }
 
 void Game::SubscribeToEvents(std::unique_ptr<EventBus>& eventBus) {
-    eventBus->SubscribeEvent<Game, KeyInputEvent>(this, &Game::OnKeyInputEvent);
+    key_input_subscription_ = eventBus->SubscribeEvent<Game, KeyInputEvent>(this, &Game::OnKeyInputEvent);
 }
 
-void Game::OnKeyInputEvent(KeyInputEvent& event) {
+void Game::OnKeyInputEvent(const KeyInputEvent& event) {
     if (!event.isPressed) {
         return;
     }
@@ -271,6 +516,9 @@ void Game::OnKeyInputEvent(KeyInputEvent& event) {
         case SDLK_F5:
             show_colliders_ = !show_colliders_;
             break;
+        case SDLK_F6:
+            clock_.SetPaused(!clock_.IsPaused());
+            break;
         default:
             break;
     }
@@ -9,11 +9,26 @@
 #include "../ECS/ECS.h"
 #include "../EventBus/EventBus.h"
 #include "../Events/KeyInputEvent.h"
+#include "../General/FrameClock.h"
+#include "../General/FramePacer.h"
+#include "../General/MemoryTracker.h"
+#include "../General/TimerWheel.h"
 #include "../Renderer/RenderQueue.h"
 #include "../Renderer/Renderer.h"
+#include "./FrameScheduler.h"
 
 const int kFps = 60;
-const int kMillisecondsPerFrame = 1000 / kFps;
+// The simulation runs in fixed ticks, independent of the frame rate.
+const int kDefaultTickRate = 60;
+// A slow frame runs at most this many ticks and drops the rest of its time,
+// so falling behind cannot snowball.
+const int kDefaultMaxTicksPerFrame = 5;
+// Deferred systems may run until this far into a frame, leaving the rest of
+// it for rendering.
+const double kDeferredBudgetSeconds = 0.5 / kFps;
+// Headless runs have no display, so scripts and systems see this size.
+const int kHeadlessWindowWidth = 1920;
+const int kHeadlessWindowHeight = 1080;
 
 class Game {
    public:
@@ -21,10 +36,19 @@ class Game {
     ~Game();
 
     void Initialize();
+    // Starts without a window, renderer, audio or ImGui.
+    void InitializeHeadless();
     void Destroy();
     void Run(bool isMapEditor);
+    // Simulates the first level tick by tick as fast as it can, until
+    // maxTicks ticks or maxSeconds of game time have run, then logs stats.
+    // A limit of zero is no limit.
+    void RunHeadless(int maxTicks, double maxSeconds);
     static void Quit() { s_is_running_ = false; }
 
+    void SetTickRate(int ticksPerSecond);
+    void SetMaxTicksPerFrame(int maxTicks);
+
     static int windowWidth;
     static int windowHeight;
     static int mapWidth;
@@ -33,23 +57,42 @@ class Game {
    private:
     void ProcessInput();
     void Update();
+    void Tick();
     void Render();
     void Setup(bool isMapEditor);
     void SubscribeToEvents(std::unique_ptr<EventBus>& eventBus);
-    void OnKeyInputEvent(KeyInputEvent& event);
+    void OnKeyInputEvent(const KeyInputEvent& event);
     KeyInputEvent GetKeyInputEvent(SDL_KeyboardEvent* event);
+    // Appends what the registry, assets, bullets and Lua hold.
+    void GetMemoryUsage(std::vector<MemoryUsage>& usage) const;
 
     SDL_Window* window_;
     SDL_Renderer* sdl_renderer_;
     SDL_Rect camera_;
     static inline bool s_is_running_{false};
+    bool is_headless_;
     bool show_colliders_;
-    int milliseconds_previous_frame_ = 0;
+    FrameClock clock_;
+    FramePacer frame_pacer_;
+    FrameScheduler frame_scheduler_;
+    TimerWheel timers_;
+    double tick_delta_time_;
+    int max_ticks_per_frame_;
+    // Frame time not yet simulated, always less than a tick after Update.
+    double tick_accumulator_;
+    // Game seconds simulated so far, a whole number of ticks.
+    double simulation_time_;
+    // How far the frame is between the previous tick and the last one.
+    float interpolation_alpha_;
 
+    // Allocates through the memory tracker so its heap size is known.
     sol::state lua;
+    // Declared before the registry so it outlives the subscriptions systems
+    // hold.
+    std::unique_ptr<EventBus> event_bus_;
+    EventSubscription key_input_subscription_;
     std::unique_ptr<Registry> registry_;
     std::unique_ptr<AssetManager> asset_manager_;
-    std::unique_ptr<EventBus> event_bus_;
     std::unique_ptr<Renderer> renderer_;
     RenderQueue render_queue_;
 };
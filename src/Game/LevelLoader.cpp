@@ -3,11 +3,16 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "../Components/SpriteComponent.h"
 #include "../Components/TransformComponent.h"
 #include "../Game/Game.h"
 #include "../General/Logger.h"
+#include "../Physics/TileGrid.h"
+#include "../Systems/CollisionSystem.h"
+#include "../Systems/MovementSystem.h"
 #include "./ECSLoader.h"
 
 LevelLoader::LevelLoader() {
@@ -34,11 +39,11 @@ void LevelLoader::LoadLevel(sol::state& lua, const std::unique_ptr<Registry>& re
     ECSLoader ecsLoader{};
     sol::table level = lua["Level"];
 
-    // Read level assets
+    // Read level assets. Headless runs have no renderer to load them into.
     sol::table assets = level["assets"];
     int i = 0;
 
-    while (true) {
+    while (renderer) {
         sol::optional<sol::table> hasAsset = assets[i];
         if (!hasAsset) {
             break;
@@ -62,7 +67,37 @@ void LevelLoader::LoadLevel(sol::state& lua, const std::unique_ptr<Registry>& re
     int tileHeight = tileMap["tile_size"];
     double tileMapScale = tileMap["scale"];
 
+    // Collision flags per tile index. Tiles without properties do not collide.
+    std::unordered_map<int, uint8_t> tileFlags;
+    sol::optional<sol::table> tileProperties = tileMap["tile_properties"];
+    if (tileProperties != sol::nullopt) {
+        for (const auto& entry : tileProperties.value()) {
+            sol::table properties = entry.second;
+            bool isSolid = properties["solid"].get_or(false);
+            bool blocksProjectiles = properties["blocks_projectiles"].get_or(isSolid);
+            uint8_t flags = 0;
+
+            if (isSolid) {
+                flags |= TileFlags::TILE_SOLID;
+            }
+            if (blocksProjectiles) {
+                flags |= TileFlags::TILE_BLOCKS_PROJECTILES;
+            }
+            tileFlags[entry.first.as<int>()] = flags;
+        }
+    }
+    std::vector<uint8_t> cellFlags;
+    // The width of the first row. The collision grid needs every row to
+    // match it.
+    int mapColumns = 0;
+    bool isRectangular = true;
+
     while (std::getline(file, line)) {
+        // Blank lines, such as a trailing newline, are not rows.
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+
         std::stringstream ss(line);
         std::string value;
         std::vector<std::string> row;
@@ -77,6 +112,9 @@ void LevelLoader::LoadLevel(sol::state& lua, const std::unique_ptr<Registry>& re
             int rowIndex = value / tileMapColumns;
             int columnIndex = value % tileMapColumns;
 
+            auto flags = tileFlags.find(value);
+            cellFlags.push_back(flags != tileFlags.end() ? flags->second : 0);
+
             auto tile = registry->CreateEntity();
             tile.Group("tiles");
             tile.AddComponent<TransformComponent>(glm::vec2(tileWidth * columnNumber * tileMapScale, tileHeight * rowNumber * tileMapScale), glm::vec2(tileMapScale, tileMapScale), 0.0);
@@ -84,16 +122,44 @@ void LevelLoader::LoadLevel(sol::state& lua, const std::unique_ptr<Registry>& re
             columnNumber++;
         }
 
+        if (rowNumber == 0) {
+            mapColumns = columnNumber;
+        } else if (columnNumber != mapColumns) {
+            isRectangular = false;
+        }
         rowNumber++;
     }
     file.close();
 
-    Game::mapWidth = columnNumber * tileWidth * tileMapScale;
+    Game::mapWidth = mapColumns * tileWidth * tileMapScale;
     Game::mapHeight = rowNumber * tileHeight * tileMapScale;
 
     lua["map_width"] = Game::mapWidth;
     lua["map_height"] = Game::mapHeight;
 
+    // Terrain collision grid. Cells are laid out by the first row's width,
+    // so a map with ragged rows gets no terrain collision.
+    auto& tileGrid = registry->GetSystem<MovementSystem>().GetTileGrid();
+    tileGrid.Clear();
+    if (!isRectangular) {
+        Logger::Error("Tilemap " + mapFile + " has rows of different lengths, its tiles will not collide.");
+    } else if (!tileFlags.empty() && mapColumns > 0) {
+        tileGrid.Reset(mapColumns, rowNumber, tileWidth * tileMapScale);
+        for (int cell = 0; cell < static_cast<int>(cellFlags.size()); cell++) {
+            tileGrid.SetFlags(cell % mapColumns, cell / mapColumns, cellFlags[cell]);
+        }
+    }
+
+    // Collision settings
+    sol::optional<sol::table> collision = level["collision"];
+    if (collision != sol::nullopt) {
+        auto& collisionSystem = registry->GetSystem<CollisionSystem>();
+        float cellSize = level["collision"]["cell_size"].get_or(kDefaultCellSize);
+        std::string broadPhase = level["collision"]["broad_phase"].get_or(std::string("spatial_hash"));
+        collisionSystem.SetCellSize(cellSize);
+        collisionSystem.SetBroadPhase(CollisionSystem::GetBroadPhaseType(broadPhase));
+    }
+
     // Create entities
     sol::table entities = level["entities"];
     i = 0;
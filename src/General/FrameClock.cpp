@@ -0,0 +1,51 @@
+#include "FrameClock.h"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+
+FrameClock::FrameClock()
+    : frequency_(SDL_GetPerformanceFrequency()),
+      previous_counter_(SDL_GetPerformanceCounter()),
+      frame_count_(0),
+      real_delta_time_(0.0),
+      real_time_(0.0),
+      delta_time_(0.0),
+      time_(0.0),
+      time_scale_(1.0),
+      manual_step_(0.0),
+      is_paused_(false) {
+}
+
+void FrameClock::Reset() {
+    previous_counter_ = SDL_GetPerformanceCounter();
+    frame_count_ = 0;
+    real_delta_time_ = 0.0;
+    real_time_ = 0.0;
+    delta_time_ = 0.0;
+    time_ = 0.0;
+}
+
+void FrameClock::Tick() {
+    const uint64_t counter = SDL_GetPerformanceCounter();
+
+    if (IsManual()) {
+        real_delta_time_ = manual_step_;
+    } else {
+        real_delta_time_ = std::min(static_cast<double>(counter - previous_counter_) / frequency_, kMaxFrameSeconds);
+    }
+
+    previous_counter_ = counter;
+    real_time_ += real_delta_time_;
+    delta_time_ = is_paused_ ? 0.0 : real_delta_time_ * time_scale_;
+    time_ += delta_time_;
+    frame_count_++;
+}
+
+void FrameClock::SetTimeScale(double timeScale) {
+    time_scale_ = std::max(timeScale, 0.0);
+}
+
+void FrameClock::SetManualStep(double seconds) {
+    manual_step_ = std::max(seconds, 0.0);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+
+// The longest step a frame can take, so a breakpoint or a dragged window does
+// not move everything a long way at once.
+const double kMaxFrameSeconds = 0.25;
+
+/**
+ * The engine's clock. It reads the performance counter once per frame in Tick
+ * and everything else reads the values it sampled, so every system sees the
+ * same time for the whole frame.
+ *
+ * Game time is what gameplay runs on. It stops while paused and runs at the
+ * time scale. In manual mode each tick advances it by a fixed step whatever
+ * the real time was, which makes headless runs repeatable.
+ */
+class FrameClock {
+   private:
+    uint64_t frequency_;
+    uint64_t previous_counter_;
+    uint64_t frame_count_;
+
+    double real_delta_time_;
+    double real_time_;
+    double delta_time_;
+    double time_;
+
+    double time_scale_;
+    double manual_step_;
+    bool is_paused_;
+
+   public:
+    FrameClock();
+    ~FrameClock() = default;
+
+    // Restarts both clocks from zero.
+    void Reset();
+
+    // Samples the counter and advances the clocks. Call once per frame.
+    void Tick();
+
+    // Game seconds since the last tick.
+    double GetDeltaTime() const {
+        return delta_time_;
+    }
+
+    // Game seconds since the clock started.
+    double GetTime() const {
+        return time_;
+    }
+
+    // Real seconds since the last tick, ignoring pause and time scale.
+    double GetRealDeltaTime() const {
+        return real_delta_time_;
+    }
+
+    // Real seconds since the clock started.
+    double GetRealTime() const {
+        return real_time_;
+    }
+
+    uint64_t GetFrameCount() const {
+        return frame_count_;
+    }
+
+    void SetPaused(bool isPaused) {
+        is_paused_ = isPaused;
+    }
+
+    bool IsPaused() const {
+        return is_paused_;
+    }
+
+    // Negative scales are treated as zero.
+    void SetTimeScale(double timeScale);
+
+    double GetTimeScale() const {
+        return time_scale_;
+    }
+
+    // Makes every tick a step of this many real seconds. Zero goes back to
+    // reading the counter.
+    void SetManualStep(double seconds);
+
+    bool IsManual() const {
+        return manual_step_ > 0.0;
+    }
+};
@@ -0,0 +1,193 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "Logger.h"
+
+// How far before the deadline sleeping stops at first, in seconds.
+const double kInitialSpinMargin = 0.002;
+// The weight of the newest frame in the adaptive mode's running averages.
+const double kAdaptiveSmoothing = 0.05;
+
+FramePacer::FramePacer()
+    : mode_(FramePacingMode::PACING_SLEEP_SPIN),
+      renderer_(nullptr),
+      is_vsync_on_(false),
+      frequency_(SDL_GetPerformanceFrequency()),
+      frame_ticks_(0),
+      next_deadline_(0),
+      previous_frame_(0),
+      spin_margin_(static_cast<uint64_t>(kInitialSpinMargin * SDL_GetPerformanceFrequency())),
+      frame_time_average_(0.0),
+      work_time_average_(0.0),
+      frame_times_(kFrameTimeSamples, 0.0),
+      next_sample_(0),
+      sample_count_(0),
+      sorted_frame_times_() {
+}
+
+void FramePacer::Initialize(SDL_Renderer* renderer, double framesPerSecond, FramePacingMode mode) {
+    renderer_ = renderer;
+    SetFrameRate(framesPerSecond);
+    SetMode(mode);
+}
+
+void FramePacer::SetMode(FramePacingMode mode) {
+    mode_ = mode;
+    SetVSync(mode == FramePacingMode::PACING_VSYNC || mode == FramePacingMode::PACING_ADAPTIVE);
+    frame_time_average_ = 0.0;
+    work_time_average_ = 0.0;
+}
+
+void FramePacer::SetFrameRate(double framesPerSecond) {
+    frame_ticks_ = static_cast<uint64_t>(frequency_ / std::max(framesPerSecond, 1.0));
+    next_deadline_ = 0;
+}
+
+void FramePacer::WaitForNextFrame() {
+    uint64_t now = SDL_GetPerformanceCounter();
+    const double workTime = previous_frame_ != 0 ? static_cast<double>(now - previous_frame_) / frequency_ : 0.0;
+
+    if (!is_vsync_on_ && mode_ != FramePacingMode::PACING_UNCAPPED) {
+        // A frame more than a whole frame late starts a new schedule instead
+        // of rushing to catch up.
+        if (next_deadline_ == 0 || now > next_deadline_ + frame_ticks_) {
+            next_deadline_ = now;
+        } else {
+            SleepUntil(next_deadline_);
+            now = SDL_GetPerformanceCounter();
+        }
+
+        next_deadline_ += frame_ticks_;
+    }
+
+    if (previous_frame_ != 0) {
+        const double frameTime = static_cast<double>(now - previous_frame_) / frequency_;
+        RecordFrameTime(frameTime);
+
+        if (mode_ == FramePacingMode::PACING_ADAPTIVE) {
+            frame_time_average_ += (frameTime - frame_time_average_) * kAdaptiveSmoothing;
+            work_time_average_ += (workTime - work_time_average_) * kAdaptiveSmoothing;
+            Adapt();
+        }
+    }
+
+    previous_frame_ = now;
+}
+
+FrameTimeStats FramePacer::GetStats() const {
+    FrameTimeStats stats = {};
+
+    if (sample_count_ == 0) {
+        return stats;
+    }
+
+    sorted_frame_times_.assign(frame_times_.begin(), frame_times_.begin() + sample_count_);
+    std::sort(sorted_frame_times_.begin(), sorted_frame_times_.end());
+
+    double sum = 0.0;
+    for (double frameTime : sorted_frame_times_) {
+        sum += frameTime;
+    }
+    stats.average = sum / sample_count_;
+
+    double squares = 0.0;
+    for (double frameTime : sorted_frame_times_) {
+        squares += (frameTime - stats.average) * (frameTime - stats.average);
+    }
+    stats.deviation = std::sqrt(squares / sample_count_);
+
+    auto percentile = [this](double fraction) {
+        const int index = static_cast<int>(std::ceil(fraction * sample_count_)) - 1;
+        return sorted_frame_times_[std::clamp(index, 0, sample_count_ - 1)];
+    };
+    stats.p50 = percentile(0.5);
+    stats.p99 = percentile(0.99);
+    stats.max = sorted_frame_times_.back();
+
+    return stats;
+}
+
+const char* FramePacer::GetModeName(FramePacingMode mode) {
+    switch (mode) {
+        case FramePacingMode::PACING_SLEEP_SPIN:
+            return "Sleep and spin";
+        case FramePacingMode::PACING_VSYNC:
+            return "Vsync";
+        case FramePacingMode::PACING_ADAPTIVE:
+            return "Adaptive";
+        case FramePacingMode::PACING_UNCAPPED:
+            return "Uncapped";
+    }
+
+    return "Unknown";
+}
+
+void FramePacer::SetVSync(bool isOn) {
+    next_deadline_ = 0;
+
+    if (!renderer_) {
+        is_vsync_on_ = false;
+        return;
+    }
+
+    if (SDL_RenderSetVSync(renderer_, isOn ? 1 : 0) != 0) {
+        Logger::Warn("Could not set vsync, pacing by sleeping instead: " + std::string(SDL_GetError()));
+        is_vsync_on_ = false;
+        return;
+    }
+
+    is_vsync_on_ = isOn;
+}
+
+void FramePacer::SleepUntil(uint64_t deadline) {
+    // Let the margin shrink back after a one off late wake.
+    const uint64_t minimumMargin = static_cast<uint64_t>(kInitialSpinMargin * frequency_);
+    spin_margin_ = std::max(minimumMargin, spin_margin_ - spin_margin_ / 64);
+
+    uint64_t now = SDL_GetPerformanceCounter();
+
+    while (deadline > now + spin_margin_) {
+        const Uint32 milliseconds = static_cast<Uint32>((deadline - now - spin_margin_) * 1000 / frequency_);
+
+        if (milliseconds == 0) {
+            break;
+        }
+
+        const uint64_t expectedWake = now + milliseconds * frequency_ / 1000;
+        SDL_Delay(milliseconds);
+        now = SDL_GetPerformanceCounter();
+
+        // Stop sleeping earlier from now on if this sleep overran the margin,
+        // but never spin for more than half a frame.
+        if (now > expectedWake + spin_margin_) {
+            spin_margin_ = std::min(now - expectedWake, frame_ticks_ / 2);
+        }
+    }
+
+    while (SDL_GetPerformanceCounter() < deadline) {
+    }
+}
+
+void FramePacer::RecordFrameTime(double seconds) {
+    frame_times_[next_sample_] = seconds;
+    next_sample_ = (next_sample_ + 1) % kFrameTimeSamples;
+    sample_count_ = std::min(sample_count_ + 1, kFrameTimeSamples);
+}
+
+void FramePacer::Adapt() {
+    const double frameSeconds = static_cast<double>(frame_ticks_) / frequency_;
+
+    // Missed refreshes show up as vsynced frames running long. Once frames
+    // are paced by sleeping they always take a frame, so the time spent
+    // working says whether they would make the refresh again.
+    if (is_vsync_on_ && frame_time_average_ > frameSeconds * 1.25) {
+        SetVSync(false);
+        work_time_average_ = frameSeconds;
+    } else if (!is_vsync_on_ && work_time_average_ < frameSeconds * 0.75) {
+        SetVSync(true);
+        frame_time_average_ = frameSeconds;
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include <cstdint>
+#include <vector>
+
+// Frame times are kept for this many frames.
+const int kFrameTimeSamples = 240;
+
+enum FramePacingMode {
+    // Sleep most of the wait, then spin on the performance counter.
+    PACING_SLEEP_SPIN,
+    // Let the renderer wait for the display's vertical sync.
+    PACING_VSYNC,
+    // Vsync while frames keep up with the display, sleep and spin while they
+    // do not, so a slow stretch is not halved to every other refresh.
+    PACING_ADAPTIVE,
+    PACING_UNCAPPED
+};
+
+struct FrameTimeStats {
+    double average;
+    double deviation;
+    double p50;
+    double p99;
+    double max;
+};
+
+/**
+ * Holds frames to a steady rate. Frames are due on a fixed schedule rather
+ * than a fixed time after the last one, so a late frame does not push every
+ * frame after it back.
+ *
+ * SDL_Delay only has millisecond resolution and wakes whenever the scheduler
+ * gets to it, so the pacer sleeps until it is within a margin of the deadline
+ * and spins the rest of the way. The margin grows to the worst oversleep it
+ * has seen.
+ */
+class FramePacer {
+   private:
+    FramePacingMode mode_;
+    SDL_Renderer* renderer_;
+    bool is_vsync_on_;
+    uint64_t frequency_;
+    uint64_t frame_ticks_;
+    uint64_t next_deadline_;
+    uint64_t previous_frame_;
+    uint64_t spin_margin_;
+    // Running averages of frame time and of the time frames spend before
+    // waiting, for adaptive pacing.
+    double frame_time_average_;
+    double work_time_average_;
+
+    std::vector<double> frame_times_;
+    int next_sample_;
+    int sample_count_;
+    mutable std::vector<double> sorted_frame_times_;
+
+    void SetVSync(bool isOn);
+    void SleepUntil(uint64_t deadline);
+    void RecordFrameTime(double seconds);
+    // Switches vsync for adaptive pacing from how recent frames kept up.
+    void Adapt();
+
+   public:
+    FramePacer();
+    ~FramePacer() = default;
+
+    // Vsync modes need the renderer. Without one they fall back to sleeping.
+    void Initialize(SDL_Renderer* renderer, double framesPerSecond, FramePacingMode mode);
+
+    void SetMode(FramePacingMode mode);
+
+    FramePacingMode GetMode() const {
+        return mode_;
+    }
+
+    bool IsVSyncOn() const {
+        return is_vsync_on_;
+    }
+
+    void SetFrameRate(double framesPerSecond);
+
+    // Waits until the next frame is due and records how long this one took.
+    // Call once per frame, before the clock ticks.
+    void WaitForNextFrame();
+
+    // Stats over the recent frames, in seconds.
+    FrameTimeStats GetStats() const;
+
+    static const char* GetModeName(FramePacingMode mode);
+};
@@ -0,0 +1,334 @@
+#include "MemoryTracker.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <new>
+
+#ifdef __GLIBC__
+#include <execinfo.h>
+#define HAS_BACKTRACE
+#endif
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+#include "Logger.h"
+#include "Profiler.h"
+
+static const char* const kOutsideScopes = "Outside scopes";
+static const char* const kOtherScopes = "Other scopes";
+
+static double ToKilobytes(size_t bytes) {
+    return bytes / 1024.0;
+}
+
+bool MemoryTracker::IsAllocationHookInstalled() {
+#ifdef TRACK_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void MemoryTracker::BeginFrame() {
+    is_frame_thread_ = true;
+}
+
+void MemoryTracker::EndFrame() {
+    if (is_expecting_no_allocations_) {
+        if (warm_up_frames_ > 0) {
+            warm_up_frames_--;
+        } else {
+            ReportAllocationSites();
+        }
+    }
+
+    std::copy(std::begin(frame_counts_), std::end(frame_counts_), std::begin(last_frame_counts_));
+    std::fill(std::begin(frame_counts_), std::end(frame_counts_), AllocationCount{nullptr, 0, 0});
+    last_other_thread_count_ = other_thread_count_.exchange(0, std::memory_order_relaxed);
+}
+
+void MemoryTracker::RecordAllocation(size_t bytes) {
+    if (!is_frame_thread_) {
+        other_thread_count_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (is_in_tracker_) {
+        return;
+    }
+
+    const char* scope = Profiler::GetCurrentScope();
+    if (!scope) {
+        scope = kOutsideScopes;
+    }
+
+    // Scope names are literals, so the pointer identifies the scope.
+    const int start = static_cast<int>((reinterpret_cast<uintptr_t>(scope) >> 3) % kMaxAllocationScopes);
+    AllocationCount* entry = &frame_counts_[kMaxAllocationScopes];
+
+    for (int i = 0; i < kMaxAllocationScopes; i++) {
+        AllocationCount& candidate = frame_counts_[(start + i) % kMaxAllocationScopes];
+        if (candidate.scope == scope || !candidate.scope) {
+            entry = &candidate;
+            break;
+        }
+    }
+
+    if (!entry->scope) {
+        entry->scope = entry == &frame_counts_[kMaxAllocationScopes] ? kOtherScopes : scope;
+    }
+    entry->count++;
+    entry->bytes += bytes;
+
+    if (is_expecting_no_allocations_ && warm_up_frames_ == 0) {
+        RecordSite(scope, bytes);
+    }
+}
+
+void MemoryTracker::RecordSite(const char* scope, size_t bytes) {
+    is_in_tracker_ = true;
+    unexpected_count_++;
+
+    void* stack[kMaxAllocationStackDepth];
+    int depth = 0;
+#ifdef HAS_BACKTRACE
+    depth = backtrace(stack, kMaxAllocationStackDepth);
+#endif
+
+    AllocationSite* site = nullptr;
+    for (int i = 0; i < site_count_ && !site; i++) {
+        AllocationSite& candidate = sites_[i];
+        if (candidate.scope == scope && candidate.depth == depth && std::memcmp(candidate.stack, stack, depth * sizeof(void*)) == 0) {
+            site = &candidate;
+        }
+    }
+
+    if (!site && site_count_ < kMaxAllocationSites) {
+        site = &sites_[site_count_++];
+        site->scope = scope;
+        std::memcpy(site->stack, stack, depth * sizeof(void*));
+        site->depth = depth;
+        site->count = 0;
+        site->bytes = 0;
+        site->isReported = false;
+    }
+
+    if (site) {
+        site->count++;
+        site->bytes += bytes;
+    }
+
+    is_in_tracker_ = false;
+}
+
+void MemoryTracker::ExpectNoAllocations(int warmUpFrames) {
+    if (!IsAllocationHookInstalled()) {
+        Logger::Warn("Allocations are only counted when built with TRACK_ALLOCATIONS.");
+    }
+
+    is_in_tracker_ = true;
+#ifdef HAS_BACKTRACE
+    // The first backtrace loads the unwinder, which allocates.
+    void* stack[1];
+    backtrace(stack, 1);
+#endif
+    site_count_ = 0;
+    unexpected_count_ = 0;
+    warm_up_frames_ = std::max(warmUpFrames, 0);
+    is_expecting_no_allocations_ = true;
+    is_in_tracker_ = false;
+}
+
+void MemoryTracker::StopExpectingNoAllocations() {
+    is_expecting_no_allocations_ = false;
+}
+
+void MemoryTracker::ReportAllocationSites() {
+    is_in_tracker_ = true;
+
+    for (int i = 0; i < site_count_; i++) {
+        AllocationSite& site = sites_[i];
+        if (site.isReported) {
+            continue;
+        }
+        site.isReported = true;
+
+        Logger::Error("Unexpected allocation in " + std::string(site.scope) + ": " + std::to_string(site.count) + " of " + std::to_string(site.bytes) + " bytes");
+
+#ifdef HAS_BACKTRACE
+        char** symbols = backtrace_symbols(site.stack, site.depth);
+        for (int frame = 0; symbols && frame < site.depth; frame++) {
+            // Symbols look like binary(mangled+offset) [address].
+            std::string symbol(symbols[frame]);
+            const size_t nameStart = symbol.find('(');
+            const size_t nameEnd = symbol.find('+', nameStart);
+
+            if (nameStart != std::string::npos && nameEnd != std::string::npos && nameEnd > nameStart + 1) {
+                symbol = GetTypeName(symbol.substr(nameStart + 1, nameEnd - nameStart - 1).c_str());
+            }
+            // The tracker's own frames say nothing about the caller.
+            if (symbol.rfind("MemoryTracker::", 0) != 0) {
+                Logger::Error("    " + symbol);
+            }
+        }
+        std::free(symbols);
+#endif
+    }
+
+    is_in_tracker_ = false;
+}
+
+std::vector<AllocationCount> MemoryTracker::GetFrameAllocations() {
+    std::vector<AllocationCount> counts;
+
+    for (const auto& count : last_frame_counts_) {
+        if (count.scope) {
+            counts.push_back(count);
+        }
+    }
+
+    std::sort(counts.begin(), counts.end(), [](const AllocationCount& a, const AllocationCount& b) {
+        return a.count > b.count;
+    });
+
+    return counts;
+}
+
+uint64_t MemoryTracker::GetFrameAllocationCount() {
+    uint64_t total = 0;
+
+    for (const auto& count : last_frame_counts_) {
+        total += count.count;
+    }
+
+    return total;
+}
+
+void* MemoryTracker::LuaAllocate(void* userData, void* pointer, size_t oldSize, size_t newSize) {
+    // Without a block, the old size is the type of object being made.
+    if (!pointer) {
+        oldSize = 0;
+    }
+
+    if (newSize == 0) {
+        std::free(pointer);
+        lua_bytes_ -= oldSize;
+        return nullptr;
+    }
+
+    void* block = std::realloc(pointer, newSize);
+    if (!block) {
+        return nullptr;
+    }
+
+    lua_bytes_ += newSize - oldSize;
+    lua_peak_bytes_ = std::max(lua_peak_bytes_, lua_bytes_);
+
+#ifdef TRACK_ALLOCATIONS
+    // Lua allocates with realloc, which the hook does not see.
+    if (newSize > oldSize) {
+        RecordAllocation(newSize);
+    }
+#endif
+
+    return block;
+}
+
+std::string MemoryTracker::GetTypeName(const char* name) {
+#ifdef __GNUG__
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+
+    if (status == 0 && demangled) {
+        std::string typeName(demangled);
+        std::free(demangled);
+        return typeName;
+    }
+#endif
+    return name;
+}
+
+bool MemoryTracker::WriteReport(const std::string& path, const std::vector<MemoryUsage>& usage) {
+    std::ofstream file(path);
+
+    if (!file) {
+        Logger::Error("Could not write memory report: " + path);
+        return false;
+    }
+
+    size_t totalReserved = 0;
+    size_t totalOverhead = 0;
+
+    file << std::fixed << std::setprecision(1);
+    file << std::left << std::setw(40) << "Name" << std::right << std::setw(10) << "Count" << std::setw(14) << "Used KB"
+         << std::setw(14) << "Reserved KB" << std::setw(14) << "Overhead KB" << "\n";
+
+    for (const auto& entry : usage) {
+        file << std::left << std::setw(40) << entry.name << std::right << std::setw(10) << entry.count
+             << std::setw(14) << ToKilobytes(entry.usedBytes) << std::setw(14) << ToKilobytes(entry.reservedBytes)
+             << std::setw(14) << ToKilobytes(entry.overheadBytes) << "\n";
+        totalReserved += entry.reservedBytes;
+        totalOverhead += entry.overheadBytes;
+    }
+
+    file << "\nTotal: " << ToKilobytes(totalReserved + totalOverhead) << " KB\n";
+    file << "Lua heap: " << ToKilobytes(lua_bytes_) << " KB, peak " << ToKilobytes(lua_peak_bytes_) << " KB\n";
+
+    if (IsAllocationHookInstalled()) {
+        file << "\nAllocations last frame: " << GetFrameAllocationCount() << ", other threads: " << last_other_thread_count_ << "\n";
+        for (const auto& count : GetFrameAllocations()) {
+            file << std::left << std::setw(40) << count.scope << std::right << std::setw(10) << count.count
+                 << std::setw(14) << ToKilobytes(count.bytes) << "\n";
+        }
+    }
+
+    Logger::Info("Wrote memory report: " + path);
+    return true;
+}
+
+#ifdef TRACK_ALLOCATIONS
+// Every allocation made with new is counted before it is passed to malloc.
+
+void* operator new(size_t size) {
+    MemoryTracker::RecordAllocation(size);
+    void* block = std::malloc(size == 0 ? 1 : size);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    MemoryTracker::RecordAllocation(size);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void* block, size_t) noexcept {
+    std::free(block);
+}
+#endif
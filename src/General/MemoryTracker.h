@@ -0,0 +1,160 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Allocations are counted per scope in a table of this size. Scopes past it
+// are counted together.
+const int kMaxAllocationScopes = 128;
+// Unexpected allocations are grouped by scope and stack, keeping this many
+// distinct sites of this many frames each.
+const int kMaxAllocationSites = 64;
+const int kMaxAllocationStackDepth = 16;
+
+struct MemoryUsage {
+    std::string name;
+    // How many elements, entries or assets are held.
+    int count;
+    // Bytes of elements in use, and bytes set aside for them.
+    size_t usedBytes;
+    size_t reservedBytes;
+    // Bookkeeping such as index maps, estimated from the container sizes.
+    size_t overheadBytes;
+};
+
+struct AllocationCount {
+    // The innermost profile scope open when the allocations were made.
+    const char* scope;
+    uint64_t count;
+    uint64_t bytes;
+};
+
+struct AllocationSite {
+    const char* scope;
+    void* stack[kMaxAllocationStackDepth];
+    int depth;
+    uint64_t count;
+    uint64_t bytes;
+    bool isReported;
+};
+
+// Estimates of what the standard containers allocate, for libstdc++. Hash
+// map nodes hold the value and a next pointer, with one pointer per bucket.
+template <typename T>
+size_t EstimateHashMapBytes(const T& map) {
+    return map.size() * (sizeof(typename T::value_type) + sizeof(void*)) + map.bucket_count() * sizeof(void*);
+}
+
+// Tree nodes hold the value, three links and a color.
+template <typename T>
+size_t EstimateTreeBytes(const T& tree) {
+    return tree.size() * (sizeof(typename T::value_type) + 4 * sizeof(void*));
+}
+
+// Strings longer than the small string buffer keep their characters on the
+// heap.
+inline size_t EstimateStringBytes(const std::string& string) {
+    return string.capacity() > 15 ? string.capacity() + 1 : 0;
+}
+
+/**
+ * Accounts for the memory the engine holds and the heap allocations it makes.
+ * Owners of large containers report what they hold as MemoryUsage entries,
+ * and the Lua state allocates through a counting allocator.
+ *
+ * Built with TRACK_ALLOCATIONS, operator new is replaced and every allocation
+ * on the frame's thread is counted against the profile scope that made it.
+ * The counts of the last finished frame are kept for display.
+ *
+ * When no allocations are expected, each one made after the warm-up frames
+ * is also recorded with its stack, and new sites are logged as the frame
+ * ends. Stacks are only captured where glibc's backtrace is available.
+ */
+class MemoryTracker {
+   private:
+    static void RecordSite(const char* scope, size_t bytes);
+
+    // The last entry counts the scopes that did not fit.
+    static inline AllocationCount frame_counts_[kMaxAllocationScopes + 1] = {};
+    static inline AllocationCount last_frame_counts_[kMaxAllocationScopes + 1] = {};
+    static inline std::atomic<uint64_t> other_thread_count_{0};
+    static inline uint64_t last_other_thread_count_{0};
+    static inline thread_local bool is_frame_thread_{false};
+    static inline AllocationSite sites_[kMaxAllocationSites] = {};
+    static inline int site_count_{0};
+    static inline uint64_t unexpected_count_{0};
+    static inline bool is_expecting_no_allocations_{false};
+    static inline int warm_up_frames_{0};
+    // Set while recording a site or reporting, whose own allocations are not
+    // counted.
+    static inline thread_local bool is_in_tracker_{false};
+    static inline size_t lua_bytes_{0};
+    static inline size_t lua_peak_bytes_{0};
+
+   public:
+    // True when built with TRACK_ALLOCATIONS.
+    static bool IsAllocationHookInstalled();
+
+    // The thread that calls BeginFrame is the one whose allocations are
+    // attributed to scopes.
+    static void BeginFrame();
+    static void EndFrame();
+
+    // Called by the operator new hook. Must not allocate.
+    static void RecordAllocation(size_t bytes);
+
+    // Allocations on the frame's thread are unexpected once warmUpFrames
+    // more frames have ended. Needs TRACK_ALLOCATIONS.
+    static void ExpectNoAllocations(int warmUpFrames);
+    static void StopExpectingNoAllocations();
+
+    static bool IsExpectingNoAllocations() {
+        return is_expecting_no_allocations_;
+    }
+
+    // Unexpected allocations since ExpectNoAllocations, and where they were
+    // made.
+    static uint64_t GetUnexpectedAllocationCount() {
+        return unexpected_count_;
+    }
+
+    static int GetAllocationSiteCount() {
+        return site_count_;
+    }
+
+    static const AllocationSite& GetAllocationSite(int index) {
+        return sites_[index];
+    }
+
+    // Logs every site that has not been logged yet, with its stack.
+    static void ReportAllocationSites();
+
+    // The last finished frame's allocations by scope, most first.
+    static std::vector<AllocationCount> GetFrameAllocations();
+    static uint64_t GetFrameAllocationCount();
+    // Allocations other threads made, which are not attributed.
+    static uint64_t GetOtherThreadAllocationCount() {
+        return last_other_thread_count_;
+    }
+
+    // A lua_Alloc that counts the bytes the Lua state holds.
+    static void* LuaAllocate(void* userData, void* pointer, size_t oldSize, size_t newSize);
+
+    static size_t GetLuaBytes() {
+        return lua_bytes_;
+    }
+
+    static size_t GetLuaPeakBytes() {
+        return lua_peak_bytes_;
+    }
+
+    // The readable name of a type_info name.
+    static std::string GetTypeName(const char* name);
+
+    // Writes the usage and the last frame's allocations as a text table.
+    // Returns false if the file could not be written.
+    static bool WriteReport(const std::string& path, const std::vector<MemoryUsage>& usage);
+};
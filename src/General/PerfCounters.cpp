@@ -0,0 +1,150 @@
+#include "PerfCounters.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "Logger.h"
+
+#ifdef __linux__
+static int OpenCounter(uint64_t config, int groupFd) {
+    perf_event_attr attributes;
+    std::memset(&attributes, 0, sizeof(attributes));
+    attributes.type = PERF_TYPE_HARDWARE;
+    attributes.size = sizeof(attributes);
+    attributes.config = config;
+    attributes.disabled = groupFd < 0 ? 1 : 0;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_GROUP;
+
+    return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, groupFd, 0));
+}
+#endif
+
+bool PerfCounters::Open() {
+    if (IsOpen()) {
+        return true;
+    }
+
+#ifdef __linux__
+    const uint64_t configs[PERF_COUNTER_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES};
+
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        counter_fds_[i] = OpenCounter(configs[i], i == 0 ? -1 : counter_fds_[0]);
+
+        if (counter_fds_[i] < 0) {
+            // No such device means the CPU, or the virtual machine, exposes no
+            // counters. Permission errors come from perf_event_paranoid.
+            const bool isDenied = errno == EACCES || errno == EPERM;
+            Logger::Warn("Could not open hardware counter " + std::to_string(i) + ": " + std::strerror(errno) + (isDenied ? ". Check /proc/sys/kernel/perf_event_paranoid." : "."));
+            Close();
+            return false;
+        }
+    }
+
+    group_fd_ = counter_fds_[0];
+    ioctl(group_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(group_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    Reset();
+    Logger::Info("Opened hardware counters.");
+    return true;
+#else
+    Logger::Warn("Hardware counters are only available on Linux.");
+    return false;
+#endif
+}
+
+void PerfCounters::Close() {
+#ifdef __linux__
+    for (int& fd : counter_fds_) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        fd = -1;
+    }
+#endif
+    group_fd_ = -1;
+}
+
+bool PerfCounters::Read(uint64_t values[PERF_COUNTER_COUNT]) {
+#ifdef __linux__
+    if (!IsOpen()) {
+        return false;
+    }
+
+    // A group read gives the number of counters, then each value in order.
+    uint64_t buffer[PERF_COUNTER_COUNT + 1];
+
+    if (read(group_fd_, buffer, sizeof(buffer)) != static_cast<ssize_t>(sizeof(buffer))) {
+        return false;
+    }
+
+    std::memcpy(values, buffer + 1, sizeof(uint64_t) * PERF_COUNTER_COUNT);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void PerfCounters::Record(const char* scope, const uint64_t start[PERF_COUNTER_COUNT], const uint64_t end[PERF_COUNTER_COUNT], int items) {
+    // Scope names are literals, so the pointer identifies the scope.
+    const int first = static_cast<int>((reinterpret_cast<uintptr_t>(scope) >> 3) % kMaxPerfScopes);
+
+    for (int i = 0; i < kMaxPerfScopes; i++) {
+        PerfScopeCounts& counts = counts_[(first + i) % kMaxPerfScopes];
+
+        if (counts.scope != scope && counts.scope) {
+            continue;
+        }
+
+        counts.scope = scope;
+        counts.calls++;
+        counts.items += std::max(items, 0);
+        for (int counter = 0; counter < PERF_COUNTER_COUNT; counter++) {
+            counts.values[counter] += end[counter] - start[counter];
+        }
+        return;
+    }
+}
+
+void PerfCounters::Reset() {
+    std::fill(std::begin(counts_), std::end(counts_), PerfScopeCounts{});
+}
+
+std::vector<PerfScopeStats> PerfCounters::GetStats() {
+    std::vector<PerfScopeStats> stats;
+
+    for (const auto& counts : counts_) {
+        if (!counts.scope) {
+            continue;
+        }
+
+        const double cycles = static_cast<double>(counts.values[PERF_CYCLES]);
+        const double items = static_cast<double>(counts.items);
+        stats.push_back({
+            counts.scope,
+            counts.calls,
+            cycles / counts.calls,
+            cycles > 0.0 ? counts.values[PERF_INSTRUCTIONS] / cycles : 0.0,
+            items > 0.0 ? counts.values[PERF_CACHE_MISSES] / items : 0.0,
+            items > 0.0 ? counts.values[PERF_BRANCH_MISSES] / items : 0.0});
+    }
+
+    std::sort(stats.begin(), stats.end(), [](const PerfScopeStats& a, const PerfScopeStats& b) {
+        return a.cyclesPerCall * a.calls > b.cyclesPerCall * b.calls;
+    });
+
+    return stats;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Counters are totalled per scope in a table of this size. Scopes past it
+// are not counted.
+const int kMaxPerfScopes = 64;
+
+enum PerfCounter {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_COUNTER_COUNT
+};
+
+struct PerfScopeCounts {
+    // The profile scope the counts were taken around.
+    const char* scope;
+    uint64_t calls;
+    // Entities or other items the scope was given to work on, over all calls.
+    uint64_t items;
+    uint64_t values[PERF_COUNTER_COUNT];
+};
+
+struct PerfScopeStats {
+    std::string name;
+    uint64_t calls;
+    double cyclesPerCall;
+    double instructionsPerCycle;
+    // Zero when the scope was not given an item count.
+    double cacheMissesPerItem;
+    double branchMissesPerItem;
+};
+
+/**
+ * Reads the CPU's performance counters around profile scopes, so a slow
+ * system can be told apart as cache bound, branch bound or simply doing too
+ * much. The counters are opened as one perf_event group on the calling
+ * thread, user space only, and all four are read with a single syscall when
+ * a scope opens and closes. Counts are totalled per scope until Reset.
+ *
+ * Linux only. Open fails elsewhere, or when perf_event_paranoid forbids it,
+ * and scopes are then not sampled.
+ */
+class PerfCounters {
+   private:
+    static inline int group_fd_{-1};
+    static inline int counter_fds_[PERF_COUNTER_COUNT] = {-1, -1, -1, -1};
+    static inline PerfScopeCounts counts_[kMaxPerfScopes] = {};
+
+   public:
+    // Returns false, with a warning, if the counters cannot be opened.
+    static bool Open();
+    static void Close();
+
+    static bool IsOpen() {
+        return group_fd_ >= 0;
+    }
+
+    // Reads every counter into values. Returns false when closed.
+    static bool Read(uint64_t values[PERF_COUNTER_COUNT]);
+
+    // Adds the counts between start and end to the scope's totals.
+    static void Record(const char* scope, const uint64_t start[PERF_COUNTER_COUNT], const uint64_t end[PERF_COUNTER_COUNT], int items);
+
+    static void Reset();
+
+    // Every scope sampled since the last Reset, most cycles first.
+    static std::vector<PerfScopeStats> GetStats();
+};
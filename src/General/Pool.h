@@ -1,11 +1,16 @@
 #pragma once
 
+#include <typeinfo>
+#include <unordered_map>
 #include <vector>
 
+#include "MemoryTracker.h"
+
 class IPool {
    public:
     virtual ~IPool() = default;
     virtual void Remove(int id) = 0;
+    virtual MemoryUsage GetMemoryUsage() const = 0;
 };
 
 /**
@@ -94,4 +99,13 @@ class Pool : public IPool {
     T& operator[](unsigned int index) {
         return data_[index];
     }
+
+    MemoryUsage GetMemoryUsage() const override {
+        return {
+            "Pool<" + MemoryTracker::GetTypeName(typeid(T).name()) + ">",
+            static_cast<int>(size_),
+            size_ * sizeof(T),
+            data_.capacity() * sizeof(T),
+            EstimateHashMapBytes(index_to_ids_) + EstimateHashMapBytes(id_to_indexes_)};
+    }
 };
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include "Profiler.h"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+#include "Logger.h"
+
+static double Percentile(const std::vector<double>& sorted, double fraction) {
+    const int count = static_cast<int>(sorted.size());
+    const int index = static_cast<int>(std::ceil(fraction * count)) - 1;
+    return sorted[std::clamp(index, 0, count - 1)];
+}
+
+static void WriteTraceEvent(std::ofstream& file, bool& isFirst, const char* name, double start, double duration) {
+    file << (isFirst ? "\n" : ",\n");
+    file << "{\"name\":\"";
+    for (const char* c = name; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            file << '\\';
+        }
+        file << *c;
+    }
+    file << "\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":" << start << ",\"dur\":" << duration << "}";
+    isFirst = false;
+}
+
+void Profiler::BeginFrame() {
+    frame_start_ = SDL_GetPerformanceCounter();
+    frame_first_event_ = event_count_.load(std::memory_order_relaxed);
+}
+
+void Profiler::EndFrame() {
+    if (!is_enabled_) {
+        return;
+    }
+
+    const uint64_t frameIndex = frame_count_.load(std::memory_order_relaxed);
+    const ProfileFrame frame = {frame_start_, SDL_GetPerformanceCounter(), frame_first_event_, event_count_.load(std::memory_order_relaxed)};
+    frames_[frameIndex % kProfilerFrameCapacity] = frame;
+    frame_count_.store(frameIndex + 1, std::memory_order_release);
+
+    if (is_export_on_spike_ && ToMilliseconds(frame.end - frame.start) > spike_seconds_ * 1000.0) {
+        const std::string path = "profile-spike-" + std::to_string(frameIndex) + ".json";
+        Logger::Warn("Frame " + std::to_string(frameIndex) + " took " + std::to_string(ToMilliseconds(frame.end - frame.start)) + " ms, writing " + path);
+        ExportChromeTrace(path);
+    }
+}
+
+void Profiler::CloseScope(const char* name, uint64_t start, uint64_t end, int depth) {
+    depth_--;
+
+    const uint64_t index = event_count_.load(std::memory_order_relaxed);
+    events_[index % kProfilerEventCapacity] = {name, start, end, depth};
+    event_count_.store(index + 1, std::memory_order_release);
+}
+
+bool Profiler::GetFrame(int framesAgo, ProfileFrame& frame) {
+    const uint64_t frameCount = frame_count_.load(std::memory_order_acquire);
+
+    if (framesAgo < 0 || static_cast<uint64_t>(framesAgo) >= std::min<uint64_t>(frameCount, kProfilerFrameCapacity)) {
+        return false;
+    }
+
+    frame = frames_[(frameCount - 1 - framesAgo) % kProfilerFrameCapacity];
+    return event_count_.load(std::memory_order_acquire) - frame.firstEvent <= kProfilerEventCapacity;
+}
+
+int Profiler::GetFrameCount() {
+    return static_cast<int>(std::min<uint64_t>(frame_count_.load(std::memory_order_acquire), kProfilerFrameCapacity));
+}
+
+bool Profiler::GetScopeMilliseconds(int framesAgo, const char* name, double& milliseconds) {
+    ProfileFrame frame;
+    if (!GetFrame(framesAgo, frame)) {
+        return false;
+    }
+
+    milliseconds = 0.0;
+    for (uint64_t i = frame.firstEvent; i < frame.lastEvent; i++) {
+        const auto& event = GetEvent(i);
+        if (std::strcmp(event.name, name) == 0) {
+            milliseconds += ToMilliseconds(event.end - event.start);
+        }
+    }
+
+    return true;
+}
+
+std::vector<ProfileScopeStats> Profiler::GetScopeStats() {
+    std::map<std::string, std::vector<double>> timesByName;
+    std::map<std::string, double> frameTotals;
+    ProfileFrame frame;
+
+    for (int framesAgo = 0; GetFrame(framesAgo, frame); framesAgo++) {
+        timesByName["Frame"].push_back(ToMilliseconds(frame.end - frame.start));
+        frameTotals.clear();
+
+        for (uint64_t i = frame.firstEvent; i < frame.lastEvent; i++) {
+            const auto& event = GetEvent(i);
+            frameTotals[event.name] += ToMilliseconds(event.end - event.start);
+        }
+
+        for (const auto& total : frameTotals) {
+            timesByName[total.first].push_back(total.second);
+        }
+    }
+
+    std::vector<ProfileScopeStats> stats;
+
+    for (auto& entry : timesByName) {
+        auto& times = entry.second;
+        std::sort(times.begin(), times.end());
+        stats.push_back({entry.first, Percentile(times, 0.5), Percentile(times, 0.95), Percentile(times, 0.99), static_cast<int>(times.size())});
+    }
+
+    std::sort(stats.begin(), stats.end(), [](const ProfileScopeStats& a, const ProfileScopeStats& b) {
+        return a.p50 > b.p50;
+    });
+
+    return stats;
+}
+
+bool Profiler::ExportChromeTrace(const std::string& path) {
+    std::ofstream file(path);
+
+    if (!file) {
+        Logger::Error("Could not write profile trace: " + path);
+        return false;
+    }
+
+    // Oldest frame first, with times in microseconds from its start.
+    int framesAgo = 0;
+    ProfileFrame frame;
+    while (GetFrame(framesAgo + 1, frame)) {
+        framesAgo++;
+    }
+
+    bool isFirst = true;
+    uint64_t origin = 0;
+    file << "{\"traceEvents\":[";
+
+    for (; framesAgo >= 0; framesAgo--) {
+        if (!GetFrame(framesAgo, frame)) {
+            continue;
+        }
+
+        if (origin == 0) {
+            origin = frame.start;
+        }
+
+        WriteTraceEvent(file, isFirst, "Frame", ToMilliseconds(frame.start - origin) * 1000.0, ToMilliseconds(frame.end - frame.start) * 1000.0);
+
+        for (uint64_t i = frame.firstEvent; i < frame.lastEvent; i++) {
+            const auto& event = GetEvent(i);
+            WriteTraceEvent(file, isFirst, event.name, ToMilliseconds(event.start - origin) * 1000.0, ToMilliseconds(event.end - event.start) * 1000.0);
+        }
+    }
+
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    Logger::Info("Wrote profile trace: " + path);
+    return true;
+}
+
+double Profiler::ToMilliseconds(uint64_t ticks) {
+    static const double millisecondsPerTick = 1000.0 / SDL_GetPerformanceFrequency();
+    return ticks * millisecondsPerTick;
+}
+
+ProfileScope::ProfileScope(const char* name, int items)
+    : name_(name),
+      previous_scope_(Profiler::SetCurrentScope(name)),
+      start_(0),
+      depth_(0),
+      is_recording_(Profiler::IsEnabled()),
+      items_(items),
+      is_counting_(false) {
+    if (is_recording_) {
+        depth_ = Profiler::OpenScope();
+        start_ = SDL_GetPerformanceCounter();
+    }
+    // Read last so the counts cover as little of the profiler as they can.
+    is_counting_ = PerfCounters::Read(counters_);
+}
+
+ProfileScope::~ProfileScope() {
+    if (is_counting_) {
+        uint64_t counters[PERF_COUNTER_COUNT];
+        if (PerfCounters::Read(counters)) {
+            PerfCounters::Record(name_, counters_, counters, items_);
+        }
+    }
+    if (is_recording_) {
+        Profiler::CloseScope(name_, start_, SDL_GetPerformanceCounter(), depth_);
+    }
+    Profiler::SetCurrentScope(previous_scope_);
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "PerfCounters.h"
+
+// Scopes and frames are kept in rings of these sizes, oldest overwritten.
+const int kProfilerEventCapacity = 1 << 16;
+const int kProfilerFrameCapacity = 240;
+
+struct ProfileEvent {
+    // Names must outlive the profiler, so they are string literals.
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+    // How many scopes were open around this one.
+    int depth;
+};
+
+struct ProfileFrame {
+    uint64_t start;
+    uint64_t end;
+    // The frame's events are the ones numbered firstEvent up to lastEvent.
+    uint64_t firstEvent;
+    uint64_t lastEvent;
+};
+
+struct ProfileScopeStats {
+    std::string name;
+    // Per frame totals in milliseconds, over the frames that ran the scope.
+    double p50;
+    double p95;
+    double p99;
+    int frames;
+};
+
+/**
+ * Records how long named scopes take, frame by frame. Scopes are timed with
+ * the performance counter and written to a ring buffer by the thread that
+ * runs the frame, which is the only writer. The ring counters are atomic, so
+ * reading needs no lock and shows when a frame's events were overwritten.
+ *
+ * The recent frames can be written out as a Chrome trace, on demand or
+ * whenever a frame runs longer than the spike threshold.
+ */
+class Profiler {
+   private:
+    static inline std::vector<ProfileEvent> events_ = std::vector<ProfileEvent>(kProfilerEventCapacity);
+    static inline std::vector<ProfileFrame> frames_ = std::vector<ProfileFrame>(kProfilerFrameCapacity);
+    static inline std::atomic<uint64_t> event_count_{0};
+    static inline std::atomic<uint64_t> frame_count_{0};
+    static inline uint64_t frame_start_{0};
+    static inline uint64_t frame_first_event_{0};
+    static inline int depth_{0};
+    static inline const char* current_scope_{nullptr};
+    static inline bool is_enabled_{true};
+    static inline bool is_export_on_spike_{false};
+    static inline double spike_seconds_{0.05};
+
+   public:
+    static void SetEnabled(bool isEnabled) {
+        is_enabled_ = isEnabled;
+    }
+
+    static bool IsEnabled() {
+        return is_enabled_;
+    }
+
+    static void BeginFrame();
+    // Closes the frame, and writes a trace if it was a spike.
+    static void EndFrame();
+
+    static int OpenScope() {
+        return depth_++;
+    }
+
+    static void CloseScope(const char* name, uint64_t start, uint64_t end, int depth);
+
+    // The innermost open scope, kept even while disabled so allocations can
+    // be attributed. Returns the scope it replaces.
+    static const char* SetCurrentScope(const char* name) {
+        const char* previous = current_scope_;
+        current_scope_ = name;
+        return previous;
+    }
+
+    static const char* GetCurrentScope() {
+        return current_scope_;
+    }
+
+    // Frames ago is 0 for the last finished frame. Returns false once the
+    // frame or any of its events has been overwritten.
+    static bool GetFrame(int framesAgo, ProfileFrame& frame);
+
+    static const ProfileEvent& GetEvent(uint64_t index) {
+        return events_[index % kProfilerEventCapacity];
+    }
+
+    static int GetFrameCount();
+
+    // The total time of the scopes with this name in the frame. Returns false
+    // once the frame or any of its events has been overwritten.
+    static bool GetScopeMilliseconds(int framesAgo, const char* name, double& milliseconds);
+
+    // Percentiles of each scope's time per frame over the recent frames.
+    static std::vector<ProfileScopeStats> GetScopeStats();
+
+    // Writes the recent frames to a Chrome trace file. Returns false if the
+    // file could not be written.
+    static bool ExportChromeTrace(const std::string& path);
+
+    static void SetExportOnSpike(bool isExportOnSpike, double spikeSeconds) {
+        is_export_on_spike_ = isExportOnSpike;
+        spike_seconds_ = spikeSeconds;
+    }
+
+    static bool IsExportOnSpike() {
+        return is_export_on_spike_;
+    }
+
+    static double GetSpikeSeconds() {
+        return spike_seconds_;
+    }
+
+    static double ToMilliseconds(uint64_t ticks);
+};
+
+/**
+ * Times the enclosing block, and samples the hardware counters around it
+ * while they are open. Items is how many entities the block works on, for
+ * per entity counts, or -1 when it does not apply.
+ */
+class ProfileScope {
+   private:
+    const char* name_;
+    const char* previous_scope_;
+    uint64_t start_;
+    int depth_;
+    bool is_recording_;
+    int items_;
+    bool is_counting_;
+    uint64_t counters_[PERF_COUNTER_COUNT];
+
+   public:
+    explicit ProfileScope(const char* name, int items = -1);
+    ~ProfileScope();
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#define PROFILE_SCOPE_JOIN(a, b) a##b
+#define PROFILE_SCOPE_NAME(line) PROFILE_SCOPE_JOIN(profile_scope_, line)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_SCOPE_NAME(__LINE__)(name)
+#define PROFILE_SCOPE_ITEMS(name, items) ProfileScope PROFILE_SCOPE_NAME(__LINE__)(name, items)
@@ -0,0 +1,191 @@
+#include "TimerWheel.h"
+
+#include <algorithm>
+#include <cmath>
+
+TimerWheel::TimerWheel()
+    : timers_(),
+      free_timers_(),
+      slots_(),
+      current_tick_(0),
+      scheduled_count_(0),
+      fired_() {
+    std::fill(std::begin(slots_), std::end(slots_), -1);
+}
+
+int TimerWheel::CreateChannel() {
+    fired_.emplace_back();
+    return static_cast<int>(fired_.size()) - 1;
+}
+
+TimerHandle TimerWheel::Schedule(int channel, double delay, double period, int data) {
+    int index;
+
+    if (free_timers_.empty()) {
+        index = static_cast<int>(timers_.size());
+        timers_.push_back({});
+    } else {
+        index = free_timers_.back();
+        free_timers_.pop_back();
+    }
+
+    auto& timer = timers_[index];
+    // Nothing can be due on the tick that has already run.
+    timer.expiry = current_tick_ + std::max<uint64_t>(ToTicks(delay), 1);
+    timer.period = period > 0.0 ? std::max<uint64_t>(ToTicks(period), 1) : 0;
+    timer.channel = channel;
+    timer.data = data;
+    Link(index);
+    scheduled_count_++;
+
+    // Every timer on the channel may fire on the same tick, so the channel's
+    // list grows here rather than while the wheel advances.
+    auto& fired = fired_[channel];
+    if (fired.capacity() < static_cast<size_t>(scheduled_count_)) {
+        fired.reserve(std::max<size_t>(fired.capacity() * 2, scheduled_count_));
+    }
+
+    return {index, timer.generation};
+}
+
+void TimerWheel::Cancel(TimerHandle& handle) {
+    if (IsScheduled(handle)) {
+        Unlink(handle.index);
+        Release(handle.index);
+    }
+
+    handle = TimerHandle();
+}
+
+bool TimerWheel::IsScheduled(TimerHandle handle) const {
+    return handle.index >= 0 && handle.index < static_cast<int>(timers_.size()) &&
+           timers_[handle.index].generation == handle.generation && timers_[handle.index].slot != -1;
+}
+
+void TimerWheel::Advance(double time) {
+    for (auto& fired : fired_) {
+        fired.clear();
+    }
+
+    const uint64_t targetTick = ToTicks(time);
+
+    while (current_tick_ < targetTick) {
+        current_tick_++;
+
+        // When a level turns over, the next slot of the level above is due to
+        // be spread over it.
+        uint64_t tick = current_tick_;
+        for (int level = 1; level < kTimerWheelLevels && (tick & (kTimerWheelSlots - 1)) == 0; level++) {
+            tick >>= kTimerWheelBits;
+            Cascade(level);
+        }
+
+        FireSlot(current_tick_ & (kTimerWheelSlots - 1));
+    }
+}
+
+void TimerWheel::Clear() {
+    for (int i = 0; i < static_cast<int>(timers_.size()); i++) {
+        if (timers_[i].slot != -1) {
+            timers_[i].slot = -1;
+            Release(i);
+        }
+    }
+
+    std::fill(std::begin(slots_), std::end(slots_), -1);
+    for (auto& fired : fired_) {
+        fired.clear();
+    }
+    current_tick_ = 0;
+}
+
+uint64_t TimerWheel::ToTicks(double seconds) {
+    return seconds > 0.0 ? static_cast<uint64_t>(std::llround(seconds / kTimerTickSeconds)) : 0;
+}
+
+void TimerWheel::Link(int index) {
+    auto& timer = timers_[index];
+    const uint64_t delta = timer.expiry - current_tick_;
+    int level = 0;
+
+    while (level < kTimerWheelLevels - 1 && delta >= (uint64_t{1} << (kTimerWheelBits * (level + 1)))) {
+        level++;
+    }
+
+    // Timers past the top level wait in its furthest slot and are placed
+    // again when it comes round.
+    uint64_t expiry = timer.expiry;
+    const uint64_t maxDelta = (uint64_t{1} << (kTimerWheelBits * kTimerWheelLevels)) - 1;
+    if (delta > maxDelta) {
+        expiry = current_tick_ + maxDelta;
+    }
+
+    const int slot = level * kTimerWheelSlots + ((expiry >> (kTimerWheelBits * level)) & (kTimerWheelSlots - 1));
+    timer.slot = slot;
+    timer.previous = -1;
+    timer.next = slots_[slot];
+
+    if (timer.next != -1) {
+        timers_[timer.next].previous = index;
+    }
+    slots_[slot] = index;
+}
+
+void TimerWheel::Unlink(int index) {
+    auto& timer = timers_[index];
+
+    if (timer.previous != -1) {
+        timers_[timer.previous].next = timer.next;
+    } else {
+        slots_[timer.slot] = timer.next;
+    }
+
+    if (timer.next != -1) {
+        timers_[timer.next].previous = timer.previous;
+    }
+
+    timer.slot = -1;
+}
+
+void TimerWheel::Release(int index) {
+    timers_[index].generation++;
+    free_timers_.push_back(index);
+    scheduled_count_--;
+}
+
+void TimerWheel::Cascade(int level) {
+    const int index = (current_tick_ >> (kTimerWheelBits * level)) & (kTimerWheelSlots - 1);
+    const int slot = level * kTimerWheelSlots + index;
+    int timer = slots_[slot];
+    slots_[slot] = -1;
+
+    while (timer != -1) {
+        const int next = timers_[timer].next;
+        Link(timer);
+        timer = next;
+    }
+}
+
+void TimerWheel::FireSlot(int slot) {
+    int timer = slots_[slot];
+    slots_[slot] = -1;
+
+    // The slot is collected first because repeating timers can be linked
+    // back into it.
+    while (timer != -1) {
+        auto& current = timers_[timer];
+        const int next = current.next;
+
+        fired_[current.channel].push_back({{timer, current.generation}, current.data});
+
+        if (current.period > 0) {
+            current.expiry += current.period;
+            Link(timer);
+        } else {
+            current.slot = -1;
+            Release(timer);
+        }
+
+        timer = next;
+    }
+}
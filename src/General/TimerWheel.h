@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Timers are kept to this resolution.
+const double kTimerTickSeconds = 0.001;
+// Each level of the wheel has 2^kTimerWheelBits slots, and each slot of a
+// level spans a whole turn of the level below.
+const int kTimerWheelBits = 6;
+const int kTimerWheelSlots = 1 << kTimerWheelBits;
+const int kTimerWheelLevels = 4;
+
+struct TimerHandle {
+    int index = -1;
+    uint32_t generation = 0;
+
+    bool IsValid() const {
+        return index != -1;
+    }
+};
+
+struct TimerFired {
+    TimerHandle handle;
+    // The value the timer was scheduled with.
+    int data;
+};
+
+/**
+ * Schedules one shot and repeating timers on a hierarchical timing wheel.
+ * Near timers sit in the slot of the tick they are due, later ones in coarser
+ * slots that are moved down a level as time reaches them, so scheduling,
+ * cancelling and firing are all constant time and a frame only costs the
+ * timers that fire in it.
+ *
+ * Timers fire into the channel they were scheduled on. The owner of a channel
+ * reads what fired after each Advance, instead of checking its timers itself.
+ */
+class TimerWheel {
+   private:
+    struct Timer {
+        uint64_t expiry;
+        // Ticks between repeats, or 0 for a one shot timer.
+        uint64_t period;
+        int channel;
+        int data;
+        int next;
+        int previous;
+        uint32_t generation;
+        // The slot the timer is linked into, or -1 when it is not scheduled.
+        int slot;
+    };
+
+    std::vector<Timer> timers_;
+    std::vector<int> free_timers_;
+    // The first timer of each slot, by level * kTimerWheelSlots + index.
+    int slots_[kTimerWheelLevels * kTimerWheelSlots];
+    uint64_t current_tick_;
+    int scheduled_count_;
+    std::vector<std::vector<TimerFired>> fired_;
+
+    static uint64_t ToTicks(double seconds);
+    void Link(int index);
+    void Unlink(int index);
+    void Release(int index);
+    // Moves the timers of a coarse slot down to the levels they now belong in.
+    void Cascade(int level);
+    void FireSlot(int slot);
+
+   public:
+    TimerWheel();
+    ~TimerWheel() = default;
+
+    // Returns a new channel to schedule timers on.
+    int CreateChannel();
+
+    // Fires once after delay seconds, then every period seconds if period is
+    // above zero.
+    TimerHandle Schedule(int channel, double delay, double period, int data);
+
+    // Stops the timer. Handles of timers that already finished are ignored.
+    void Cancel(TimerHandle& handle);
+
+    bool IsScheduled(TimerHandle handle) const;
+
+    int GetScheduledCount() const {
+        return scheduled_count_;
+    }
+
+    // Runs the wheel up to time, in seconds, and collects what fired. The
+    // timers fired by the previous call are dropped.
+    void Advance(double time);
+
+    // The timers of the channel that fired in the last Advance, in the order
+    // they were due.
+    const std::vector<TimerFired>& GetFired(int channel) const {
+        return fired_[channel];
+    }
+
+    // Drops every timer and starts again from time zero.
+    void Clear();
+};
@@ -1,19 +1,80 @@
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <string>
 
 #include "./Game/Game.h"
 #include "./General/Logger.h"
+#include "./General/MemoryTracker.h"
+#include "./General/PerfCounters.h"
+
+// Headless runs with no limit given simulate a minute of game time.
+const int kDefaultHeadlessTicks = kDefaultTickRate * 60;
+// Ticks that may allocate while levels, pools and caches fill up, before
+// allocations are unexpected.
+const int kDefaultWarmUpTicks = kDefaultTickRate * 2;
 
 int main(int argc, char* argv[]) {
     Logger::Init();
     bool isMapEditor = false;
+    bool isHeadless = false;
+    int headlessTicks = 0;
+    double headlessSeconds = 0.0;
+    bool isExpectingNoAllocations = false;
+    int warmUpTicks = kDefaultWarmUpTicks;
+    bool isCountingPerf = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-m") == 0) {
+            Logger::Info("Map Editor mode enabled.");
+            isMapEditor = true;
+        } else if (strcmp(argv[i], "--headless") == 0) {
+            isHeadless = true;
+        } else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            headlessTicks = std::atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            headlessSeconds = std::atof(argv[++i]);
+        } else if (strcmp(argv[i], "--expect-no-allocations") == 0) {
+            isExpectingNoAllocations = true;
+        } else if (strcmp(argv[i], "--warm-up") == 0 && i + 1 < argc) {
+            warmUpTicks = std::atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--perf-counters") == 0) {
+            isCountingPerf = true;
+        } else {
+            Logger::Warn("Unknown argument: " + std::string(argv[i]));
+        }
+    }
 
-    if (argc > 1 && strcmp(argv[1], "-m") == 0) {
-        Logger::Info("Map Editor mode enabled.");
-        isMapEditor = true;
+    // Opened before the run so the counters follow this thread.
+    if (isCountingPerf) {
+        PerfCounters::Open();
     }
 
     Game game;
 
+    if (isHeadless) {
+        if (isMapEditor) {
+            Logger::Warn("The map editor needs a window, running the game headless instead.");
+        }
+
+        if (headlessTicks <= 0 && headlessSeconds <= 0.0) {
+            headlessTicks = kDefaultHeadlessTicks;
+        }
+
+        if (isExpectingNoAllocations) {
+            MemoryTracker::ExpectNoAllocations(warmUpTicks);
+        }
+
+        game.InitializeHeadless();
+        game.RunHeadless(headlessTicks, headlessSeconds);
+        game.Destroy();
+
+        if (isExpectingNoAllocations && (!MemoryTracker::IsAllocationHookInstalled() || MemoryTracker::GetUnexpectedAllocationCount() > 0)) {
+            return 1;
+        }
+        return 0;
+    }
+
     game.Initialize();
     game.Run(isMapEditor);
     game.Destroy();
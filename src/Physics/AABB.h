@@ -0,0 +1,73 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <utility>
+
+/**
+ * An axis aligned bounding box in world space.
+ */
+struct AABB {
+    glm::vec2 min;
+    glm::vec2 max;
+
+    AABB(glm::vec2 min = glm::vec2(0), glm::vec2 max = glm::vec2(0)) : min(min), max(max) {
+    }
+
+    // Touching edges count as an overlap to match the original collision test.
+    bool Overlaps(const AABB& other) const {
+        return !(min.x > other.max.x || max.x < other.min.x || max.y < other.min.y || min.y > other.max.y);
+    }
+
+    bool Contains(const AABB& other) const {
+        return min.x <= other.min.x && min.y <= other.min.y && max.x >= other.max.x && max.y >= other.max.y;
+    }
+
+    bool Contains(glm::vec2 point) const {
+        return min.x <= point.x && min.y <= point.y && max.x >= point.x && max.y >= point.y;
+    }
+
+    float GetPerimeter() const {
+        return 2.0f * ((max.x - min.x) + (max.y - min.y));
+    }
+
+    AABB Expanded(float margin) const {
+        return AABB(min - glm::vec2(margin), max + glm::vec2(margin));
+    }
+
+    static AABB Combine(const AABB& a, const AABB& b) {
+        return AABB(glm::min(a.min, b.min), glm::max(a.max, b.max));
+    }
+
+    // Slab test of the segment from -> to. On a hit, fraction is where along
+    // the segment the box is entered, 0 if from is already inside.
+    bool Raycast(glm::vec2 from, glm::vec2 to, float& fraction) const {
+        const glm::vec2 delta = to - from;
+        float enter = 0.0f;
+        float exit = 1.0f;
+
+        for (int axis = 0; axis < 2; axis++) {
+            if (glm::abs(delta[axis]) < 1e-6f) {
+                if (from[axis] < min[axis] || from[axis] > max[axis]) {
+                    return false;
+                }
+                continue;
+            }
+
+            const float inverse = 1.0f / delta[axis];
+            float nearHit = (min[axis] - from[axis]) * inverse;
+            float farHit = (max[axis] - from[axis]) * inverse;
+            if (nearHit > farHit) {
+                std::swap(nearHit, farHit);
+            }
+
+            enter = glm::max(enter, nearHit);
+            exit = glm::min(exit, farHit);
+            if (enter > exit) {
+                return false;
+            }
+        }
+
+        fraction = enter;
+        return true;
+    }
+};
@@ -0,0 +1,116 @@
+#include "AABBTreeBroadPhase.h"
+
+#include <algorithm>
+
+AABBTreeBroadPhase::AABBTreeBroadPhase(float margin)
+    : static_tree_(margin), dynamic_tree_(margin), handles_(), free_handles_(), handle_by_entity_() {
+}
+
+void AABBTreeBroadPhase::FindPairs(const std::vector<ColliderProxy>& proxies, std::vector<CollisionPair>& pairs) {
+    for (auto& handle : handles_) {
+        handle.isSeen = false;
+    }
+
+    const int proxyCount = static_cast<int>(proxies.size());
+
+    for (int i = 0; i < proxyCount; i++) {
+        const auto& proxy = proxies[i];
+        const int entityId = proxy.entity.GetId();
+        if (entityId >= static_cast<int>(handle_by_entity_.size())) {
+            handle_by_entity_.resize(entityId + 1, -1);
+        }
+
+        if (handle_by_entity_[entityId] == -1) {
+            AddHandle(proxy, i);
+            continue;
+        }
+
+        auto& handle = handles_[handle_by_entity_[entityId]];
+        handle.proxy = i;
+        handle.isSeen = true;
+
+        if (handle.isStatic && !proxy.isStatic) {
+            SetStatic(handle, proxy.bounds, false);
+        } else if (!handle.isStatic && proxy.isStatic && !handle.hasMoved) {
+            SetStatic(handle, proxy.bounds, true);
+        } else if (GetTree(handle).MoveProxy(handle.node, proxy.bounds) && handle.isStatic) {
+            handle.hasMoved = true;
+            SetStatic(handle, proxy.bounds, false);
+        }
+    }
+
+    RemoveUnseenHandles();
+
+    // Only dynamic proxies go looking for pairs. Within the dynamic tree the
+    // pair is reported from the proxy with the lower index.
+    for (int i = 0; i < proxyCount; i++) {
+        const auto& handle = handles_[handle_by_entity_[proxies[i].entity.GetId()]];
+        if (handle.isStatic) {
+            continue;
+        }
+
+        const AABB& fatAABB = dynamic_tree_.GetFatAABB(handle.node);
+
+        dynamic_tree_.Query(fatAABB, [&](int node) {
+            const int other = GetProxyIndex(dynamic_tree_, node);
+            if (other > i && proxies[i].ShouldCollide(proxies[other])) {
+                pairs.emplace_back(i, other);
+            }
+            return true;
+        });
+
+        static_tree_.Query(fatAABB, [&](int node) {
+            const int other = GetProxyIndex(static_tree_, node);
+            if (proxies[i].ShouldCollide(proxies[other])) {
+                pairs.emplace_back(std::min(i, other), std::max(i, other));
+            }
+            return true;
+        });
+    }
+}
+
+void AABBTreeBroadPhase::AddHandle(const ColliderProxy& proxy, int proxyIndex) {
+    int handleIndex;
+
+    if (free_handles_.empty()) {
+        handleIndex = static_cast<int>(handles_.size());
+        handles_.emplace_back();
+    } else {
+        handleIndex = free_handles_.back();
+        free_handles_.pop_back();
+    }
+
+    auto& handle = handles_[handleIndex];
+    handle.entityId = proxy.entity.GetId();
+    handle.proxy = proxyIndex;
+    handle.isStatic = proxy.isStatic;
+    handle.hasMoved = false;
+    handle.isSeen = true;
+    handle.node = GetTree(handle).CreateProxy(proxy.bounds, handleIndex);
+
+    handle_by_entity_[handle.entityId] = handleIndex;
+}
+
+void AABBTreeBroadPhase::RemoveUnseenHandles() {
+    const int handleCount = static_cast<int>(handles_.size());
+
+    for (int i = 0; i < handleCount; i++) {
+        auto& handle = handles_[i];
+        if (handle.entityId == -1 || handle.isSeen) {
+            continue;
+        }
+
+        GetTree(handle).DestroyProxy(handle.node);
+        handle_by_entity_[handle.entityId] = -1;
+        handle.entityId = -1;
+        free_handles_.push_back(i);
+    }
+}
+
+void AABBTreeBroadPhase::SetStatic(Handle& handle, const AABB& bounds, bool isStatic) {
+    const int handleIndex = static_cast<int>(&handle - handles_.data());
+
+    GetTree(handle).DestroyProxy(handle.node);
+    handle.isStatic = isStatic;
+    handle.node = GetTree(handle).CreateProxy(bounds, handleIndex);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+
+#include "./BroadPhase.h"
+#include "./DynamicAABBTree.h"
+
+/**
+ * A broad phase built on two dynamic AABB trees. Static colliders live in their
+ * own tree and are only ever queried by dynamic ones, so static pairs are never
+ * tested. A static collider that moves out of its fat box is promoted to the
+ * dynamic tree for good. Dynamic proxies that turn static, like sleeping
+ * bodies, go back to the static tree.
+ */
+class AABBTreeBroadPhase : public IBroadPhase {
+   private:
+    struct Handle {
+        int entityId;
+        int proxy;
+        int node;
+        bool isStatic;
+        // Set once a static proxy has moved out of its fat box. Such proxies
+        // stay dynamic even if they claim to be static again.
+        bool hasMoved;
+        bool isSeen;
+    };
+
+    DynamicAABBTree static_tree_;
+    DynamicAABBTree dynamic_tree_;
+
+    std::vector<Handle> handles_;
+    std::vector<int> free_handles_;
+    std::vector<int> handle_by_entity_;
+
+    void AddHandle(const ColliderProxy& proxy, int proxyIndex);
+    void RemoveUnseenHandles();
+    void SetStatic(Handle& handle, const AABB& bounds, bool isStatic);
+
+    DynamicAABBTree& GetTree(const Handle& handle) {
+        return handle.isStatic ? static_tree_ : dynamic_tree_;
+    }
+
+    int GetProxyIndex(const DynamicAABBTree& tree, int node) const {
+        return handles_[tree.GetUserData(node)].proxy;
+    }
+
+   public:
+    AABBTreeBroadPhase(float margin = kDefaultAABBMargin);
+    ~AABBTreeBroadPhase() = default;
+
+    void FindPairs(const std::vector<ColliderProxy>& proxies, std::vector<CollisionPair>& pairs) override;
+
+    const DynamicAABBTree& GetStaticTree() const {
+        return static_tree_;
+    }
+
+    const DynamicAABBTree& GetDynamicTree() const {
+        return dynamic_tree_;
+    }
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../ECS/ECS.h"
+#include "./AABB.h"
+
+enum BroadPhaseType {
+    BRUTE_FORCE,
+    SPATIAL_HASH,
+    SWEEP_AND_PRUNE,
+    AABB_TREE
+};
+
+// A collider snapshot taken once per frame so the broad and narrow phases never
+// have to go back to the component pools.
+struct ColliderProxy {
+    Entity entity;
+    AABB bounds;
+    // Static colliders are not expected to move. Broad phases may skip testing
+    // them against each other.
+    bool isStatic;
+    uint32_t category;
+    uint32_t collidesWith;
+
+    ColliderProxy(Entity entity, AABB bounds, bool isStatic = false, uint32_t category = 1, uint32_t collidesWith = 0xFFFFFFFFu)
+        : entity(entity), bounds(bounds), isStatic(isStatic), category(category), collidesWith(collidesWith) {
+    }
+
+    // Both colliders have to accept each other's layers. Broad phases check this
+    // before any AABB math.
+    bool ShouldCollide(const ColliderProxy& other) const {
+        return (category & other.collidesWith) != 0 && (other.category & collidesWith) != 0;
+    }
+};
+
+// A candidate pair of indexes into the proxy list, with a < b.
+struct CollisionPair {
+    int a;
+    int b;
+
+    CollisionPair(int a, int b) : a(a), b(b) {
+    }
+};
+
+/**
+ * Finds the pairs of colliders that could be overlapping so the narrow phase
+ * only has to test those.
+ */
+class IBroadPhase {
+   public:
+    virtual ~IBroadPhase() = default;
+
+    // Fills pairs with every candidate pair whose layers interact. Each pair is
+    // reported once.
+    virtual void FindPairs(const std::vector<ColliderProxy>& proxies, std::vector<CollisionPair>& pairs) = 0;
+};
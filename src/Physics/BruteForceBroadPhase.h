@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+
+#include "./BroadPhase.h"
+#include "./ColliderSoA.h"
+
+/**
+ * Tests every collider against every other collider. Only the overlapping pairs
+ * are reported since the candidate list would otherwise be quadratic too.
+ */
+class BruteForceBroadPhase : public IBroadPhase {
+   private:
+    ColliderSoA colliders_;
+
+   public:
+    void FindPairs(const std::vector<ColliderProxy>& proxies, std::vector<CollisionPair>& pairs) override {
+        const int count = static_cast<int>(proxies.size());
+
+        colliders_.Clear();
+        colliders_.Reserve(count);
+        for (const auto& proxy : proxies) {
+            colliders_.Add(proxy.bounds, proxy.category, proxy.collidesWith);
+        }
+
+        for (int i = 0; i < count; i++) {
+            colliders_.FindOverlaps(i, i + 1, count, pairs);
+        }
+    }
+};
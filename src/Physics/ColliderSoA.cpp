@@ -0,0 +1,287 @@
+#include "ColliderSoA.h"
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#define COLLIDER_SOA_X86
+#include <immintrin.h>
+#endif
+
+// Raw views of the columns so the kernels do not have to go through the class.
+struct ColliderColumns {
+    const float* minX;
+    const float* minY;
+    const float* maxX;
+    const float* maxY;
+    const uint32_t* category;
+    const uint32_t* collidesWith;
+};
+
+static bool ShouldReport(const ColliderColumns& columns, int a, int b) {
+    const bool layersInteract = (columns.category[a] & columns.collidesWith[b]) != 0 &&
+                                (columns.category[b] & columns.collidesWith[a]) != 0;
+    const bool separated = columns.minX[a] > columns.maxX[b] || columns.maxX[a] < columns.minX[b] ||
+                           columns.maxY[a] < columns.minY[b] || columns.minY[a] > columns.maxY[b];
+    return layersInteract && !separated;
+}
+
+static void FindOverlapsScalar(const ColliderColumns& columns, int box, int first, int last, std::vector<CollisionPair>& pairs) {
+    for (int i = first; i < last; i++) {
+        if (ShouldReport(columns, box, i)) {
+            pairs.emplace_back(box, i);
+        }
+    }
+}
+
+static void FilterScalar(const ColliderColumns& columns, const CollisionPair* candidates, int count, std::vector<CollisionPair>& overlapping) {
+    for (int i = 0; i < count; i++) {
+        if (ShouldReport(columns, candidates[i].a, candidates[i].b)) {
+            overlapping.push_back(candidates[i]);
+        }
+    }
+}
+
+#ifdef COLLIDER_SOA_X86
+
+// The kernels build a bit per lane that is set when the pair must be skipped,
+// so the surviving lanes can be appended by walking the cleared bits.
+
+static void FindOverlapsSSE2(const ColliderColumns& columns, int box, int first, int last, std::vector<CollisionPair>& pairs) {
+    const __m128 minX = _mm_set1_ps(columns.minX[box]);
+    const __m128 minY = _mm_set1_ps(columns.minY[box]);
+    const __m128 maxX = _mm_set1_ps(columns.maxX[box]);
+    const __m128 maxY = _mm_set1_ps(columns.maxY[box]);
+    const __m128i category = _mm_set1_epi32(static_cast<int>(columns.category[box]));
+    const __m128i collidesWith = _mm_set1_epi32(static_cast<int>(columns.collidesWith[box]));
+    const __m128i zero = _mm_setzero_si128();
+
+    int i = first;
+    for (; i + 4 <= last; i += 4) {
+        __m128 skip = _mm_cmpgt_ps(minX, _mm_loadu_ps(columns.maxX + i));
+        skip = _mm_or_ps(skip, _mm_cmplt_ps(maxX, _mm_loadu_ps(columns.minX + i)));
+        skip = _mm_or_ps(skip, _mm_cmplt_ps(maxY, _mm_loadu_ps(columns.minY + i)));
+        skip = _mm_or_ps(skip, _mm_cmpgt_ps(minY, _mm_loadu_ps(columns.maxY + i)));
+
+        const __m128i otherCategory = _mm_loadu_si128(reinterpret_cast<const __m128i*>(columns.category + i));
+        const __m128i otherCollidesWith = _mm_loadu_si128(reinterpret_cast<const __m128i*>(columns.collidesWith + i));
+        const __m128i layerSkip = _mm_or_si128(
+            _mm_cmpeq_epi32(_mm_and_si128(category, otherCollidesWith), zero),
+            _mm_cmpeq_epi32(_mm_and_si128(otherCategory, collidesWith), zero));
+        skip = _mm_or_ps(skip, _mm_castsi128_ps(layerSkip));
+
+        int hits = ~_mm_movemask_ps(skip) & 0xF;
+        while (hits != 0) {
+            pairs.emplace_back(box, i + __builtin_ctz(hits));
+            hits &= hits - 1;
+        }
+    }
+
+    FindOverlapsScalar(columns, box, i, last, pairs);
+}
+
+static void FilterSSE2(const ColliderColumns& columns, const CollisionPair* candidates, int count, std::vector<CollisionPair>& overlapping) {
+    // SSE2 has no gather, so the lanes are filled one load at a time.
+    auto gather = [](const float* column, const CollisionPair* pairs, int CollisionPair::*side) {
+        return _mm_setr_ps(column[pairs[0].*side], column[pairs[1].*side], column[pairs[2].*side], column[pairs[3].*side]);
+    };
+    auto gatherInt = [](const uint32_t* column, const CollisionPair* pairs, int CollisionPair::*side) {
+        return _mm_setr_epi32(
+            static_cast<int>(column[pairs[0].*side]),
+            static_cast<int>(column[pairs[1].*side]),
+            static_cast<int>(column[pairs[2].*side]),
+            static_cast<int>(column[pairs[3].*side]));
+    };
+    const __m128i zero = _mm_setzero_si128();
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const CollisionPair* pairs = candidates + i;
+
+        __m128 skip = _mm_cmpgt_ps(gather(columns.minX, pairs, &CollisionPair::a), gather(columns.maxX, pairs, &CollisionPair::b));
+        skip = _mm_or_ps(skip, _mm_cmplt_ps(gather(columns.maxX, pairs, &CollisionPair::a), gather(columns.minX, pairs, &CollisionPair::b)));
+        skip = _mm_or_ps(skip, _mm_cmplt_ps(gather(columns.maxY, pairs, &CollisionPair::a), gather(columns.minY, pairs, &CollisionPair::b)));
+        skip = _mm_or_ps(skip, _mm_cmpgt_ps(gather(columns.minY, pairs, &CollisionPair::a), gather(columns.maxY, pairs, &CollisionPair::b)));
+
+        const __m128i layerSkip = _mm_or_si128(
+            _mm_cmpeq_epi32(_mm_and_si128(gatherInt(columns.category, pairs, &CollisionPair::a), gatherInt(columns.collidesWith, pairs, &CollisionPair::b)), zero),
+            _mm_cmpeq_epi32(_mm_and_si128(gatherInt(columns.category, pairs, &CollisionPair::b), gatherInt(columns.collidesWith, pairs, &CollisionPair::a)), zero));
+        skip = _mm_or_ps(skip, _mm_castsi128_ps(layerSkip));
+
+        int hits = ~_mm_movemask_ps(skip) & 0xF;
+        while (hits != 0) {
+            overlapping.push_back(pairs[__builtin_ctz(hits)]);
+            hits &= hits - 1;
+        }
+    }
+
+    FilterScalar(columns, candidates + i, count - i, overlapping);
+}
+
+__attribute__((target("avx2"))) static void FindOverlapsAVX2(const ColliderColumns& columns, int box, int first, int last, std::vector<CollisionPair>& pairs) {
+    const __m256 minX = _mm256_set1_ps(columns.minX[box]);
+    const __m256 minY = _mm256_set1_ps(columns.minY[box]);
+    const __m256 maxX = _mm256_set1_ps(columns.maxX[box]);
+    const __m256 maxY = _mm256_set1_ps(columns.maxY[box]);
+    const __m256i category = _mm256_set1_epi32(static_cast<int>(columns.category[box]));
+    const __m256i collidesWith = _mm256_set1_epi32(static_cast<int>(columns.collidesWith[box]));
+    const __m256i zero = _mm256_setzero_si256();
+
+    int i = first;
+    for (; i + 8 <= last; i += 8) {
+        __m256 skip = _mm256_cmp_ps(minX, _mm256_loadu_ps(columns.maxX + i), _CMP_GT_OQ);
+        skip = _mm256_or_ps(skip, _mm256_cmp_ps(maxX, _mm256_loadu_ps(columns.minX + i), _CMP_LT_OQ));
+        skip = _mm256_or_ps(skip, _mm256_cmp_ps(maxY, _mm256_loadu_ps(columns.minY + i), _CMP_LT_OQ));
+        skip = _mm256_or_ps(skip, _mm256_cmp_ps(minY, _mm256_loadu_ps(columns.maxY + i), _CMP_GT_OQ));
+
+        const __m256i otherCategory = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns.category + i));
+        const __m256i otherCollidesWith = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns.collidesWith + i));
+        const __m256i layerSkip = _mm256_or_si256(
+            _mm256_cmpeq_epi32(_mm256_and_si256(category, otherCollidesWith), zero),
+            _mm256_cmpeq_epi32(_mm256_and_si256(otherCategory, collidesWith), zero));
+        skip = _mm256_or_ps(skip, _mm256_castsi256_ps(layerSkip));
+
+        int hits = ~_mm256_movemask_ps(skip) & 0xFF;
+        while (hits != 0) {
+            pairs.emplace_back(box, i + __builtin_ctz(hits));
+            hits &= hits - 1;
+        }
+    }
+
+    FindOverlapsScalar(columns, box, i, last, pairs);
+}
+
+__attribute__((target("avx2"))) static void FilterAVX2(const ColliderColumns& columns, const CollisionPair* candidates, int count, std::vector<CollisionPair>& overlapping) {
+    const __m256i zero = _mm256_setzero_si256();
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const CollisionPair* pairs = candidates + i;
+
+        // Split the interleaved a, b indexes of 8 pairs into one vector each.
+        const __m256 low = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pairs)));
+        const __m256 high = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pairs + 4)));
+        const __m256i a = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0));
+        const __m256i b = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0));
+
+        __m256 skip = _mm256_cmp_ps(_mm256_i32gather_ps(columns.minX, a, 4), _mm256_i32gather_ps(columns.maxX, b, 4), _CMP_GT_OQ);
+        skip = _mm256_or_ps(skip, _mm256_cmp_ps(_mm256_i32gather_ps(columns.maxX, a, 4), _mm256_i32gather_ps(columns.minX, b, 4), _CMP_LT_OQ));
+        skip = _mm256_or_ps(skip, _mm256_cmp_ps(_mm256_i32gather_ps(columns.maxY, a, 4), _mm256_i32gather_ps(columns.minY, b, 4), _CMP_LT_OQ));
+        skip = _mm256_or_ps(skip, _mm256_cmp_ps(_mm256_i32gather_ps(columns.minY, a, 4), _mm256_i32gather_ps(columns.maxY, b, 4), _CMP_GT_OQ));
+
+        const int* category = reinterpret_cast<const int*>(columns.category);
+        const int* collidesWith = reinterpret_cast<const int*>(columns.collidesWith);
+        const __m256i layerSkip = _mm256_or_si256(
+            _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_i32gather_epi32(category, a, 4), _mm256_i32gather_epi32(collidesWith, b, 4)), zero),
+            _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_i32gather_epi32(category, b, 4), _mm256_i32gather_epi32(collidesWith, a, 4)), zero));
+        skip = _mm256_or_ps(skip, _mm256_castsi256_ps(layerSkip));
+
+        int hits = ~_mm256_movemask_ps(skip) & 0xFF;
+        while (hits != 0) {
+            overlapping.push_back(pairs[__builtin_ctz(hits)]);
+            hits &= hits - 1;
+        }
+    }
+
+    FilterScalar(columns, candidates + i, count - i, overlapping);
+}
+
+#endif
+
+static OverlapKernel GetBestSupportedKernel() {
+#ifdef COLLIDER_SOA_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return OverlapKernel::AVX2;
+    }
+    return OverlapKernel::SSE2;
+#else
+    return OverlapKernel::SCALAR;
+#endif
+}
+
+static OverlapKernel active_kernel = GetBestSupportedKernel();
+
+void ColliderSoA::Clear() {
+    min_x_.clear();
+    min_y_.clear();
+    max_x_.clear();
+    max_y_.clear();
+    category_.clear();
+    collides_with_.clear();
+}
+
+void ColliderSoA::Reserve(int count) {
+    min_x_.reserve(count);
+    min_y_.reserve(count);
+    max_x_.reserve(count);
+    max_y_.reserve(count);
+    category_.reserve(count);
+    collides_with_.reserve(count);
+}
+
+int ColliderSoA::Add(const AABB& bounds, uint32_t category, uint32_t collidesWith) {
+    min_x_.push_back(bounds.min.x);
+    min_y_.push_back(bounds.min.y);
+    max_x_.push_back(bounds.max.x);
+    max_y_.push_back(bounds.max.y);
+    category_.push_back(category);
+    collides_with_.push_back(collidesWith);
+    return GetSize() - 1;
+}
+
+void ColliderSoA::FindOverlaps(int box, int first, int last, std::vector<CollisionPair>& pairs) const {
+    const ColliderColumns columns = {
+        min_x_.data(), min_y_.data(), max_x_.data(), max_y_.data(), category_.data(), collides_with_.data()};
+
+    switch (active_kernel) {
+#ifdef COLLIDER_SOA_X86
+        case OverlapKernel::AVX2:
+            FindOverlapsAVX2(columns, box, first, last, pairs);
+            break;
+        case OverlapKernel::SSE2:
+            FindOverlapsSSE2(columns, box, first, last, pairs);
+            break;
+#endif
+        default:
+            FindOverlapsScalar(columns, box, first, last, pairs);
+            break;
+    }
+}
+
+void ColliderSoA::FilterOverlapping(const std::vector<CollisionPair>& candidates, std::vector<CollisionPair>& overlapping) const {
+    const ColliderColumns columns = {
+        min_x_.data(), min_y_.data(), max_x_.data(), max_y_.data(), category_.data(), collides_with_.data()};
+    const int count = static_cast<int>(candidates.size());
+
+    switch (active_kernel) {
+#ifdef COLLIDER_SOA_X86
+        case OverlapKernel::AVX2:
+            FilterAVX2(columns, candidates.data(), count, overlapping);
+            break;
+        case OverlapKernel::SSE2:
+            FilterSSE2(columns, candidates.data(), count, overlapping);
+            break;
+#endif
+        default:
+            FilterScalar(columns, candidates.data(), count, overlapping);
+            break;
+    }
+}
+
+OverlapKernel ColliderSoA::GetKernel() {
+    return active_kernel;
+}
+
+void ColliderSoA::SetKernel(OverlapKernel kernel) {
+    const OverlapKernel best = GetBestSupportedKernel();
+    active_kernel = kernel > best ? best : kernel;
+}
+
+const char* ColliderSoA::GetKernelName(OverlapKernel kernel) {
+    switch (kernel) {
+        case OverlapKernel::AVX2:
+            return "AVX2";
+        case OverlapKernel::SSE2:
+            return "SSE2";
+        default:
+            return "Scalar";
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "./AABB.h"
+#include "./BroadPhase.h"
+
+enum OverlapKernel {
+    SCALAR,
+    SSE2,
+    AVX2
+};
+
+/**
+ * World space collider boxes packed into one array per bound so the overlap
+ * tests can compare 4 or 8 boxes at once. The kernel is picked at startup from
+ * what the CPU supports, with a scalar fallback for everything else.
+ */
+class ColliderSoA {
+   private:
+    std::vector<float> min_x_;
+    std::vector<float> min_y_;
+    std::vector<float> max_x_;
+    std::vector<float> max_y_;
+    std::vector<uint32_t> category_;
+    std::vector<uint32_t> collides_with_;
+
+   public:
+    ColliderSoA() = default;
+    ~ColliderSoA() = default;
+
+    void Clear();
+
+    void Reserve(int count);
+
+    // Returns the index of the new box.
+    int Add(const AABB& bounds, uint32_t category, uint32_t collidesWith);
+
+    int GetSize() const {
+        return static_cast<int>(min_x_.size());
+    }
+
+    AABB GetBounds(int index) const {
+        return AABB(glm::vec2(min_x_[index], min_y_[index]), glm::vec2(max_x_[index], max_y_[index]));
+    }
+
+    // Appends (box, candidate) for every candidate in [first, last) whose layers
+    // interact with box and whose bounds overlap it.
+    void FindOverlaps(int box, int first, int last, std::vector<CollisionPair>& pairs) const;
+
+    // Appends every candidate pair whose layers interact and whose bounds
+    // overlap, keeping the candidate order.
+    void FilterOverlapping(const std::vector<CollisionPair>& candidates, std::vector<CollisionPair>& overlapping) const;
+
+    static OverlapKernel GetKernel();
+
+    // Forces a kernel. Kernels the CPU does not support fall back to the best
+    // supported one.
+    static void SetKernel(OverlapKernel kernel);
+
+    static const char* GetKernelName(OverlapKernel kernel);
+};
@@ -0,0 +1,58 @@
+#include "ContactCache.h"
+
+#include <utility>
+
+ContactCache::ContactCache() : pairs_(), pair_indexes_(), frame_(0) {
+}
+
+uint64_t ContactCache::GetKey(int idA, int idB) {
+    if (idA > idB) {
+        std::swap(idA, idB);
+    }
+    return (static_cast<uint64_t>(static_cast<uint32_t>(idA)) << 32) | static_cast<uint32_t>(idB);
+}
+
+void ContactCache::Update(const std::vector<ColliderProxy>& proxies, const std::vector<CollisionPair>& overlapping, std::vector<Contact>& contacts) {
+    contacts.clear();
+    frame_++;
+
+    for (const auto& pair : overlapping) {
+        const Entity entityA = proxies[pair.a].entity;
+        const Entity entityB = proxies[pair.b].entity;
+        const uint64_t key = GetKey(entityA.GetId(), entityB.GetId());
+        const auto found = pair_indexes_.find(key);
+
+        if (found == pair_indexes_.end()) {
+            pair_indexes_.emplace(key, static_cast<int>(pairs_.size()));
+            pairs_.push_back({key, entityA, entityB, frame_});
+            contacts.emplace_back(entityA, entityB, ContactPhase::CONTACT_BEGIN);
+        } else {
+            pairs_[found->second].lastSeenFrame = frame_;
+            contacts.emplace_back(entityA, entityB, ContactPhase::CONTACT_STAY);
+        }
+    }
+
+    // Pairs not seen this frame have separated, or one of them is gone.
+    for (int i = 0; i < static_cast<int>(pairs_.size());) {
+        const auto& cached = pairs_[i];
+
+        if (cached.lastSeenFrame == frame_) {
+            i++;
+            continue;
+        }
+
+        contacts.emplace_back(cached.entityA, cached.entityB, ContactPhase::CONTACT_END);
+        pair_indexes_.erase(cached.key);
+
+        if (i != static_cast<int>(pairs_.size()) - 1) {
+            pairs_[i] = pairs_.back();
+            pair_indexes_[pairs_[i].key] = i;
+        }
+        pairs_.pop_back();
+    }
+}
+
+void ContactCache::Clear() {
+    pairs_.clear();
+    pair_indexes_.clear();
+}
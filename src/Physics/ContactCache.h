@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "../ECS/ECS.h"
+#include "./BroadPhase.h"
+
+enum ContactPhase {
+    CONTACT_BEGIN,
+    CONTACT_STAY,
+    CONTACT_END
+};
+
+struct Contact {
+    Entity entityA;
+    Entity entityB;
+    ContactPhase phase;
+
+    Contact(Entity entityA, Entity entityB, ContactPhase phase) : entityA(entityA), entityB(entityB), phase(phase) {
+    }
+};
+
+/**
+ * Remembers which collider pairs overlapped last frame so overlaps can be
+ * reported as the contact beginning, staying or ending instead of a new
+ * collision every frame.
+ */
+class ContactCache {
+   private:
+    struct CachedPair {
+        uint64_t key;
+        Entity entityA;
+        Entity entityB;
+        uint32_t lastSeenFrame;
+    };
+
+    // Dense so ending contacts can be found with a linear sweep.
+    std::vector<CachedPair> pairs_;
+    std::unordered_map<uint64_t, int> pair_indexes_;
+    uint32_t frame_;
+
+    static uint64_t GetKey(int idA, int idB);
+
+   public:
+    ContactCache();
+    ~ContactCache() = default;
+
+    // Replaces contacts with this frame's contacts: begin and stay contacts in
+    // the order of overlapping, followed by the end contacts. The entities of an
+    // end contact may have been destroyed since they last overlapped.
+    void Update(const std::vector<ColliderProxy>& proxies, const std::vector<CollisionPair>& overlapping, std::vector<Contact>& contacts);
+
+    void Clear();
+
+    int GetPairCount() const {
+        return static_cast<int>(pairs_.size());
+    }
+};
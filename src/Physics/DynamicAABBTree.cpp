@@ -0,0 +1,238 @@
+#include "DynamicAABBTree.h"
+
+#include <algorithm>
+
+DynamicAABBTree::DynamicAABBTree(float margin)
+    : nodes_(), root_(kNullNode), free_list_(kNullNode), proxy_count_(0), margin_(margin) {
+}
+
+int DynamicAABBTree::AllocateNode() {
+    int node;
+
+    if (free_list_ == kNullNode) {
+        node = static_cast<int>(nodes_.size());
+        nodes_.emplace_back();
+    } else {
+        node = free_list_;
+        free_list_ = nodes_[node].parent;
+    }
+
+    auto& newNode = nodes_[node];
+    newNode.parent = kNullNode;
+    newNode.child1 = kNullNode;
+    newNode.child2 = kNullNode;
+    newNode.height = 0;
+    newNode.userData = -1;
+    return node;
+}
+
+void DynamicAABBTree::FreeNode(int node) {
+    nodes_[node].parent = free_list_;
+    nodes_[node].height = -1;
+    free_list_ = node;
+}
+
+void DynamicAABBTree::Clear() {
+    nodes_.clear();
+    root_ = kNullNode;
+    free_list_ = kNullNode;
+    proxy_count_ = 0;
+}
+
+int DynamicAABBTree::CreateProxy(const AABB& aabb, int userData) {
+    const int proxyId = AllocateNode();
+    nodes_[proxyId].aabb = aabb.Expanded(margin_);
+    nodes_[proxyId].userData = userData;
+
+    InsertLeaf(proxyId);
+    proxy_count_++;
+    return proxyId;
+}
+
+void DynamicAABBTree::DestroyProxy(int proxyId) {
+    RemoveLeaf(proxyId);
+    FreeNode(proxyId);
+    proxy_count_--;
+}
+
+bool DynamicAABBTree::MoveProxy(int proxyId, const AABB& aabb) {
+    if (nodes_[proxyId].aabb.Contains(aabb)) {
+        return false;
+    }
+
+    RemoveLeaf(proxyId);
+    nodes_[proxyId].aabb = aabb.Expanded(margin_);
+    InsertLeaf(proxyId);
+    return true;
+}
+
+void DynamicAABBTree::InsertLeaf(int leaf) {
+    if (root_ == kNullNode) {
+        root_ = leaf;
+        nodes_[leaf].parent = kNullNode;
+        return;
+    }
+
+    // Walk down to the sibling that grows the total perimeter the least.
+    const AABB leafAABB = nodes_[leaf].aabb;
+    int index = root_;
+
+    while (!nodes_[index].IsLeaf()) {
+        const auto& node = nodes_[index];
+        const float perimeter = node.aabb.GetPerimeter();
+        const float combinedPerimeter = AABB::Combine(node.aabb, leafAABB).GetPerimeter();
+
+        // Cost of making a new parent for this node and the leaf.
+        const float cost = 2.0f * combinedPerimeter;
+
+        // Minimum cost of pushing the leaf further down the tree.
+        const float inheritanceCost = 2.0f * (combinedPerimeter - perimeter);
+
+        auto descendCost = [&](int child) {
+            const auto& childNode = nodes_[child];
+            const float childPerimeter = AABB::Combine(leafAABB, childNode.aabb).GetPerimeter();
+            if (childNode.IsLeaf()) {
+                return childPerimeter + inheritanceCost;
+            }
+            return childPerimeter - childNode.aabb.GetPerimeter() + inheritanceCost;
+        };
+
+        const float cost1 = descendCost(node.child1);
+        const float cost2 = descendCost(node.child2);
+
+        if (cost < cost1 && cost < cost2) {
+            break;
+        }
+
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    const int sibling = index;
+    const int oldParent = nodes_[sibling].parent;
+    const int newParent = AllocateNode();
+
+    nodes_[newParent].parent = oldParent;
+    nodes_[newParent].aabb = AABB::Combine(leafAABB, nodes_[sibling].aabb);
+    nodes_[newParent].height = nodes_[sibling].height + 1;
+    nodes_[newParent].child1 = sibling;
+    nodes_[newParent].child2 = leaf;
+    nodes_[sibling].parent = newParent;
+    nodes_[leaf].parent = newParent;
+
+    if (oldParent == kNullNode) {
+        root_ = newParent;
+    } else if (nodes_[oldParent].child1 == sibling) {
+        nodes_[oldParent].child1 = newParent;
+    } else {
+        nodes_[oldParent].child2 = newParent;
+    }
+
+    RefitAncestors(newParent);
+}
+
+void DynamicAABBTree::RemoveLeaf(int leaf) {
+    if (leaf == root_) {
+        root_ = kNullNode;
+        return;
+    }
+
+    const int parent = nodes_[leaf].parent;
+    const int grandParent = nodes_[parent].parent;
+    const int sibling = nodes_[parent].child1 == leaf ? nodes_[parent].child2 : nodes_[parent].child1;
+
+    // The sibling takes the place of the parent.
+    if (grandParent == kNullNode) {
+        root_ = sibling;
+        nodes_[sibling].parent = kNullNode;
+        FreeNode(parent);
+        return;
+    }
+
+    if (nodes_[grandParent].child1 == parent) {
+        nodes_[grandParent].child1 = sibling;
+    } else {
+        nodes_[grandParent].child2 = sibling;
+    }
+    nodes_[sibling].parent = grandParent;
+    FreeNode(parent);
+
+    RefitAncestors(grandParent);
+}
+
+void DynamicAABBTree::RefitAncestors(int node) {
+    int index = node;
+
+    while (index != kNullNode) {
+        index = Balance(index);
+
+        auto& current = nodes_[index];
+        const auto& child1 = nodes_[current.child1];
+        const auto& child2 = nodes_[current.child2];
+        current.height = 1 + std::max(child1.height, child2.height);
+        current.aabb = AABB::Combine(child1.aabb, child2.aabb);
+
+        index = current.parent;
+    }
+}
+
+// Rotates the taller child of node up if the subtree is unbalanced and returns
+// the index of the new subtree root.
+int DynamicAABBTree::Balance(int node) {
+    const int a = node;
+    if (nodes_[a].IsLeaf() || nodes_[a].height < 2) {
+        return a;
+    }
+
+    const int b = nodes_[a].child1;
+    const int c = nodes_[a].child2;
+    const int balance = nodes_[c].height - nodes_[b].height;
+
+    // Moves up into the place of a. Its taller child stays with it and the
+    // shorter one is handed to a in place of up.
+    auto rotateUp = [this, a](int up, int stay, bool upIsChild2) {
+        const int f = nodes_[up].child1;
+        const int g = nodes_[up].child2;
+
+        nodes_[up].child1 = a;
+        nodes_[up].parent = nodes_[a].parent;
+        nodes_[a].parent = up;
+
+        const int upParent = nodes_[up].parent;
+        if (upParent == kNullNode) {
+            root_ = up;
+        } else if (nodes_[upParent].child1 == a) {
+            nodes_[upParent].child1 = up;
+        } else {
+            nodes_[upParent].child2 = up;
+        }
+
+        // The taller grandchild stays under up, the shorter one moves to a.
+        const int taller = nodes_[f].height > nodes_[g].height ? f : g;
+        const int shorter = taller == f ? g : f;
+
+        nodes_[up].child2 = taller;
+        if (upIsChild2) {
+            nodes_[a].child2 = shorter;
+        } else {
+            nodes_[a].child1 = shorter;
+        }
+        nodes_[shorter].parent = a;
+
+        nodes_[a].aabb = AABB::Combine(nodes_[stay].aabb, nodes_[shorter].aabb);
+        nodes_[a].height = 1 + std::max(nodes_[stay].height, nodes_[shorter].height);
+        nodes_[up].aabb = AABB::Combine(nodes_[a].aabb, nodes_[taller].aabb);
+        nodes_[up].height = 1 + std::max(nodes_[a].height, nodes_[taller].height);
+
+        return up;
+    };
+
+    if (balance > 1) {
+        return rotateUp(c, b, true);
+    }
+
+    if (balance < -1) {
+        return rotateUp(b, c, false);
+    }
+
+    return a;
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <vector>
+
+#include "./AABB.h"
+
+const int kNullNode = -1;
+const float kDefaultAABBMargin = 8.0f;
+
+/**
+ * A bounding volume hierarchy of fat AABBs. Leaves are only reinserted when
+ * their tight box leaves the fat box, so slow moving proxies rarely touch the
+ * tree. The tree is kept balanced with AVL style rotations.
+ */
+class DynamicAABBTree {
+   private:
+    struct TreeNode {
+        AABB aabb;
+        // Parent index, or the next free node while on the free list.
+        int parent;
+        int child1;
+        int child2;
+        // Leaves have a height of 0, free nodes -1.
+        int height;
+        int userData;
+
+        bool IsLeaf() const {
+            return child1 == kNullNode;
+        }
+    };
+
+    // A small stack for the tree walks that only allocates for very deep trees.
+    class NodeStack {
+       private:
+        static const int kInlineCapacity = 128;
+        int inline_[kInlineCapacity];
+        std::vector<int> overflow_;
+        int size_;
+
+       public:
+        NodeStack() : size_(0) {
+        }
+
+        bool IsEmpty() const {
+            return size_ == 0;
+        }
+
+        void Push(int node) {
+            if (size_ < kInlineCapacity) {
+                inline_[size_] = node;
+            } else {
+                overflow_.push_back(node);
+            }
+            size_++;
+        }
+
+        int Pop() {
+            size_--;
+            if (size_ < kInlineCapacity) {
+                return inline_[size_];
+            }
+            const int node = overflow_.back();
+            overflow_.pop_back();
+            return node;
+        }
+    };
+
+    std::vector<TreeNode> nodes_;
+    int root_;
+    int free_list_;
+    int proxy_count_;
+    float margin_;
+
+    int AllocateNode();
+    void FreeNode(int node);
+    void InsertLeaf(int leaf);
+    void RemoveLeaf(int leaf);
+    int Balance(int node);
+    void RefitAncestors(int node);
+
+   public:
+    DynamicAABBTree(float margin = kDefaultAABBMargin);
+    ~DynamicAABBTree() = default;
+
+    // Returns the id of the new proxy. The stored box is fattened by the margin.
+    int CreateProxy(const AABB& aabb, int userData);
+
+    void DestroyProxy(int proxyId);
+
+    // Returns true if the proxy had to be reinserted.
+    bool MoveProxy(int proxyId, const AABB& aabb);
+
+    void Clear();
+
+    int GetUserData(int proxyId) const {
+        return nodes_[proxyId].userData;
+    }
+
+    const AABB& GetFatAABB(int proxyId) const {
+        return nodes_[proxyId].aabb;
+    }
+
+    int GetProxyCount() const {
+        return proxy_count_;
+    }
+
+    int GetHeight() const {
+        return root_ == kNullNode ? 0 : nodes_[root_].height;
+    }
+
+    // Calls callback(proxyId) for every proxy whose fat box overlaps aabb.
+    // The callback returns false to stop the query.
+    template <typename TCallback>
+    void Query(const AABB& aabb, TCallback&& callback) const;
+
+    // Calls callback(proxyId) for every proxy whose fat box contains point.
+    template <typename TCallback>
+    void QueryPoint(glm::vec2 point, TCallback&& callback) const;
+
+    // Calls callback(proxyId, maxFraction) for every proxy whose fat box is hit
+    // by the segment from -> to. The callback returns the new max fraction to
+    // clip the segment, 0 to stop, or maxFraction to carry on unchanged.
+    template <typename TCallback>
+    void Raycast(glm::vec2 from, glm::vec2 to, TCallback&& callback) const;
+};
+
+template <typename TCallback>
+void DynamicAABBTree::Query(const AABB& aabb, TCallback&& callback) const {
+    if (root_ == kNullNode) {
+        return;
+    }
+
+    NodeStack stack;
+    stack.Push(root_);
+
+    while (!stack.IsEmpty()) {
+        const int index = stack.Pop();
+        const auto& node = nodes_[index];
+
+        if (!node.aabb.Overlaps(aabb)) {
+            continue;
+        }
+
+        if (node.IsLeaf()) {
+            if (!callback(index)) {
+                return;
+            }
+        } else {
+            stack.Push(node.child1);
+            stack.Push(node.child2);
+        }
+    }
+}
+
+template <typename TCallback>
+void DynamicAABBTree::QueryPoint(glm::vec2 point, TCallback&& callback) const {
+    if (root_ == kNullNode) {
+        return;
+    }
+
+    NodeStack stack;
+    stack.Push(root_);
+
+    while (!stack.IsEmpty()) {
+        const int index = stack.Pop();
+        const auto& node = nodes_[index];
+
+        if (!node.aabb.Contains(point)) {
+            continue;
+        }
+
+        if (node.IsLeaf()) {
+            if (!callback(index)) {
+                return;
+            }
+        } else {
+            stack.Push(node.child1);
+            stack.Push(node.child2);
+        }
+    }
+}
+
+template <typename TCallback>
+void DynamicAABBTree::Raycast(glm::vec2 from, glm::vec2 to, TCallback&& callback) const {
+    if (root_ == kNullNode) {
+        return;
+    }
+
+    float maxFraction = 1.0f;
+    NodeStack stack;
+    stack.Push(root_);
+
+    while (!stack.IsEmpty()) {
+        const int index = stack.Pop();
+        const auto& node = nodes_[index];
+        const glm::vec2 clippedTo = from + (to - from) * maxFraction;
+        float fraction;
+
+        if (!node.aabb.Raycast(from, clippedTo, fraction)) {
+            continue;
+        }
+
+        if (node.IsLeaf()) {
+            const float value = callback(index, maxFraction);
+            if (value <= 0.0f) {
+                return;
+            }
+            maxFraction = glm::min(maxFraction, value);
+        } else {
+            stack.Push(node.child1);
+            stack.Push(node.child2);
+        }
+    }
+}
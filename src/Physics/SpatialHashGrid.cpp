@@ -0,0 +1,113 @@
+#include "SpatialHashGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../General/Logger.h"
+
+SpatialHashGrid::SpatialHashGrid(float cellSize) : cell_size_(), inverse_cell_size_() {
+    SetCellSize(cellSize);
+}
+
+void SpatialHashGrid::SetCellSize(float cellSize) {
+    if (cellSize <= 0.0f) {
+        Logger::Warn("Invalid spatial hash cell size: " + std::to_string(cellSize) + ". Using the default.");
+        cellSize = kDefaultCellSize;
+    }
+
+    cell_size_ = cellSize;
+    inverse_cell_size_ = 1.0f / cellSize;
+}
+
+int SpatialHashGrid::ToCell(float value) const {
+    return static_cast<int>(std::floor(value * inverse_cell_size_));
+}
+
+uint32_t SpatialHashGrid::HashCell(int cellX, int cellY) {
+    return (static_cast<uint32_t>(cellX) * 73856093u) ^ (static_cast<uint32_t>(cellY) * 19349663u);
+}
+
+void SpatialHashGrid::FindPairs(const std::vector<ColliderProxy>& proxies, std::vector<CollisionPair>& pairs) {
+    const int proxyCount = static_cast<int>(proxies.size());
+
+    entries_.clear();
+    min_cells_.resize(proxyCount * 2);
+
+    for (int i = 0; i < proxyCount; i++) {
+        const auto& bounds = proxies[i].bounds;
+        const int minX = ToCell(bounds.min.x);
+        const int minY = ToCell(bounds.min.y);
+        const int maxX = ToCell(bounds.max.x);
+        const int maxY = ToCell(bounds.max.y);
+
+        min_cells_[i * 2] = minX;
+        min_cells_[i * 2 + 1] = minY;
+
+        for (int y = minY; y <= maxY; y++) {
+            for (int x = minX; x <= maxX; x++) {
+                entries_.push_back({x, y, i});
+            }
+        }
+    }
+
+    if (entries_.empty()) {
+        return;
+    }
+
+    // Counting sort the entries by bucket so every cell ends up contiguous.
+    size_t bucketCount = 1;
+    while (bucketCount < entries_.size()) {
+        bucketCount <<= 1;
+    }
+    const uint32_t bucketMask = static_cast<uint32_t>(bucketCount - 1);
+
+    bucket_starts_.assign(bucketCount + 1, 0);
+    for (const auto& entry : entries_) {
+        bucket_starts_[(HashCell(entry.cellX, entry.cellY) & bucketMask) + 1]++;
+    }
+
+    for (size_t i = 1; i <= bucketCount; i++) {
+        bucket_starts_[i] += bucket_starts_[i - 1];
+    }
+
+    // Scattering advances each start to the end of its bucket, which is also
+    // the start of the next one.
+    sorted_entries_.resize(entries_.size());
+    for (const auto& entry : entries_) {
+        sorted_entries_[bucket_starts_[HashCell(entry.cellX, entry.cellY) & bucketMask]++] = entry;
+    }
+
+    int bucketStart = 0;
+    for (size_t bucket = 0; bucket < bucketCount; bucket++) {
+        const int bucketEnd = bucket_starts_[bucket];
+
+        for (int i = bucketStart; i < bucketEnd; i++) {
+            const auto& entryA = sorted_entries_[i];
+
+            for (int j = i + 1; j < bucketEnd; j++) {
+                const auto& entryB = sorted_entries_[j];
+
+                // Different cells can hash into the same bucket.
+                if (entryA.cellX != entryB.cellX || entryA.cellY != entryB.cellY) {
+                    continue;
+                }
+
+                if (!proxies[entryA.proxy].ShouldCollide(proxies[entryB.proxy])) {
+                    continue;
+                }
+
+                // Colliders sharing several cells are only reported from the
+                // first cell of their overlap.
+                const int firstSharedX = std::max(min_cells_[entryA.proxy * 2], min_cells_[entryB.proxy * 2]);
+                const int firstSharedY = std::max(min_cells_[entryA.proxy * 2 + 1], min_cells_[entryB.proxy * 2 + 1]);
+                if (entryA.cellX != firstSharedX || entryA.cellY != firstSharedY) {
+                    continue;
+                }
+
+                pairs.emplace_back(std::min(entryA.proxy, entryB.proxy), std::max(entryA.proxy, entryB.proxy));
+            }
+        }
+
+        bucketStart = bucketEnd;
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "./BroadPhase.h"
+
+const float kDefaultCellSize = 64.0f;
+
+/**
+ * A uniform grid broad phase. Colliders are hashed into every cell they touch
+ * and only colliders sharing a cell are reported as candidates. The grid is
+ * rebuilt each frame with a counting sort so the cost stays linear in the
+ * number of colliders.
+ */
+class SpatialHashGrid : public IBroadPhase {
+   private:
+    struct CellEntry {
+        int cellX;
+        int cellY;
+        int proxy;
+    };
+
+    float cell_size_;
+    float inverse_cell_size_;
+
+    // Scratch buffers reused across frames to avoid reallocating.
+    std::vector<CellEntry> entries_;
+    std::vector<CellEntry> sorted_entries_;
+    std::vector<int> bucket_starts_;
+    std::vector<int> min_cells_;
+
+    int ToCell(float value) const;
+    static uint32_t HashCell(int cellX, int cellY);
+
+   public:
+    SpatialHashGrid(float cellSize = kDefaultCellSize);
+    ~SpatialHashGrid() = default;
+
+    float GetCellSize() const {
+        return cell_size_;
+    }
+
+    void SetCellSize(float cellSize);
+
+    void FindPairs(const std::vector<ColliderProxy>& proxies, std::vector<CollisionPair>& pairs) override;
+};
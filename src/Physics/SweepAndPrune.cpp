@@ -0,0 +1,246 @@
+#include "SweepAndPrune.h"
+
+#include <algorithm>
+
+uint64_t SweepAndPrune::MakePairKey(int boxA, int boxB) {
+    const auto low = static_cast<uint64_t>(std::min(boxA, boxB));
+    const auto high = static_cast<uint64_t>(std::max(boxA, boxB));
+    return (low << 32) | high;
+}
+
+// Min endpoints sort before max endpoints of the same value so that touching
+// boxes are treated as overlapping, like AABB::Overlaps.
+bool SweepAndPrune::ShouldSwap(const Endpoint& previous, const Endpoint& current) {
+    return previous.value > current.value || (previous.value == current.value && previous.IsMax() && !current.IsMax());
+}
+
+float SweepAndPrune::GetEndpointValue(const Endpoint& endpoint, int axis) const {
+    const auto& bounds = boxes_[endpoint.GetBox()].bounds;
+    return endpoint.IsMax() ? bounds.max[axis] : bounds.min[axis];
+}
+
+void SweepAndPrune::FindPairs(const std::vector<ColliderProxy>& proxies, std::vector<CollisionPair>& pairs) {
+    for (auto& box : boxes_) {
+        box.isSeen = false;
+    }
+
+    added_boxes_.clear();
+
+    // Refresh the boxes we already know about and collect the new ones.
+    const int proxyCount = static_cast<int>(proxies.size());
+    for (int i = 0; i < proxyCount; i++) {
+        const int entityId = proxies[i].entity.GetId();
+        if (entityId >= static_cast<int>(box_by_entity_.size())) {
+            box_by_entity_.resize(entityId + 1, -1);
+        }
+
+        const int boxIndex = box_by_entity_[entityId];
+        if (boxIndex == -1) {
+            added_boxes_.push_back(i);
+            continue;
+        }
+
+        auto& box = boxes_[boxIndex];
+        box.bounds = proxies[i].bounds;
+        box.proxy = i;
+        box.isSeen = true;
+    }
+
+    RemoveBoxes();
+
+    for (auto& proxyIndex : added_boxes_) {
+        proxyIndex = AddBox(proxies[proxyIndex], proxyIndex);
+    }
+
+    const int boxCount = static_cast<int>(boxes_.size() - free_boxes_.size());
+    const bool isMostlyNew = static_cast<int>(added_boxes_.size()) * 4 > boxCount;
+
+    if (isMostlyNew) {
+        // Insertion sort degrades badly when most of the endpoints are new.
+        Rebuild();
+    } else {
+        for (int axis = 0; axis < 2; axis++) {
+            for (const auto boxIndex : added_boxes_) {
+                endpoints_[axis].push_back({0.0f, static_cast<uint32_t>(boxIndex) << 1});
+                endpoints_[axis].push_back({0.0f, (static_cast<uint32_t>(boxIndex) << 1) | 1});
+            }
+
+            for (auto& endpoint : endpoints_[axis]) {
+                endpoint.value = GetEndpointValue(endpoint, axis);
+            }
+
+            InsertionSort(axis);
+        }
+    }
+
+    // The overlap set ignores layers so it stays valid when they change, the
+    // filter is applied when reporting.
+    for (const auto key : pairs_) {
+        const int proxyA = boxes_[static_cast<int>(key >> 32)].proxy;
+        const int proxyB = boxes_[static_cast<int>(key & 0xFFFFFFFF)].proxy;
+        if (proxies[proxyA].ShouldCollide(proxies[proxyB])) {
+            pairs.emplace_back(std::min(proxyA, proxyB), std::max(proxyA, proxyB));
+        }
+    }
+}
+
+int SweepAndPrune::AddBox(const ColliderProxy& proxy, int proxyIndex) {
+    const int entityId = proxy.entity.GetId();
+    int boxIndex;
+
+    if (free_boxes_.empty()) {
+        boxIndex = static_cast<int>(boxes_.size());
+        boxes_.push_back({entityId, proxyIndex, proxy.bounds, true});
+    } else {
+        boxIndex = free_boxes_.back();
+        free_boxes_.pop_back();
+        boxes_[boxIndex] = {entityId, proxyIndex, proxy.bounds, true};
+    }
+
+    box_by_entity_[entityId] = boxIndex;
+    return boxIndex;
+}
+
+void SweepAndPrune::RemoveBoxes() {
+    removed_boxes_.clear();
+    const int boxCount = static_cast<int>(boxes_.size());
+
+    for (int i = 0; i < boxCount; i++) {
+        if (boxes_[i].entityId != -1 && !boxes_[i].isSeen) {
+            removed_boxes_.push_back(i);
+        }
+    }
+
+    if (removed_boxes_.empty()) {
+        return;
+    }
+
+    auto isRemoved = [this](int boxIndex) {
+        return !boxes_[boxIndex].isSeen;
+    };
+
+    for (auto& endpoints : endpoints_) {
+        endpoints.erase(
+            std::remove_if(
+                endpoints.begin(),
+                endpoints.end(),
+                [&isRemoved](const Endpoint& endpoint) {
+                    return isRemoved(endpoint.GetBox());
+                }),
+            endpoints.end());
+    }
+
+    for (int i = static_cast<int>(pairs_.size()) - 1; i >= 0; i--) {
+        const auto key = pairs_[i];
+        if (isRemoved(static_cast<int>(key >> 32)) || isRemoved(static_cast<int>(key & 0xFFFFFFFF))) {
+            RemovePair(static_cast<int>(key >> 32), static_cast<int>(key & 0xFFFFFFFF));
+        }
+    }
+
+    for (const auto boxIndex : removed_boxes_) {
+        box_by_entity_[boxes_[boxIndex].entityId] = -1;
+        boxes_[boxIndex].entityId = -1;
+        free_boxes_.push_back(boxIndex);
+    }
+}
+
+void SweepAndPrune::AddPair(int boxA, int boxB) {
+    const auto key = MakePairKey(boxA, boxB);
+    if (pair_indexes_.find(key) != pair_indexes_.end()) {
+        return;
+    }
+
+    pair_indexes_.emplace(key, static_cast<int>(pairs_.size()));
+    pairs_.push_back(key);
+}
+
+void SweepAndPrune::RemovePair(int boxA, int boxB) {
+    auto it = pair_indexes_.find(MakePairKey(boxA, boxB));
+    if (it == pair_indexes_.end()) {
+        return;
+    }
+
+    const int index = it->second;
+    const auto lastKey = pairs_.back();
+    pairs_[index] = lastKey;
+    pair_indexes_[lastKey] = index;
+    pairs_.pop_back();
+    pair_indexes_.erase(it);
+}
+
+void SweepAndPrune::InsertionSort(int axis) {
+    auto& endpoints = endpoints_[axis];
+    const int count = static_cast<int>(endpoints.size());
+
+    for (int i = 1; i < count; i++) {
+        const Endpoint current = endpoints[i];
+        int j = i;
+
+        while (j > 0 && ShouldSwap(endpoints[j - 1], current)) {
+            const Endpoint& previous = endpoints[j - 1];
+            const int currentBox = current.GetBox();
+            const int previousBox = previous.GetBox();
+
+            if (!current.IsMax() && previous.IsMax()) {
+                // A min moved below a max, the boxes may have started overlapping.
+                if (boxes_[currentBox].bounds.Overlaps(boxes_[previousBox].bounds)) {
+                    AddPair(currentBox, previousBox);
+                }
+            } else if (current.IsMax() && !previous.IsMax()) {
+                // A max moved below a min, the boxes stopped overlapping.
+                RemovePair(currentBox, previousBox);
+            }
+
+            endpoints[j] = previous;
+            j--;
+        }
+
+        endpoints[j] = current;
+    }
+}
+
+void SweepAndPrune::Rebuild() {
+    const int boxCount = static_cast<int>(boxes_.size());
+
+    for (int axis = 0; axis < 2; axis++) {
+        auto& endpoints = endpoints_[axis];
+        endpoints.clear();
+
+        for (int i = 0; i < boxCount; i++) {
+            if (boxes_[i].entityId == -1) {
+                continue;
+            }
+
+            endpoints.push_back({boxes_[i].bounds.min[axis], static_cast<uint32_t>(i) << 1});
+            endpoints.push_back({boxes_[i].bounds.max[axis], (static_cast<uint32_t>(i) << 1) | 1});
+        }
+
+        std::sort(endpoints.begin(), endpoints.end(), [](const Endpoint& a, const Endpoint& b) {
+            return ShouldSwap(b, a);
+        });
+    }
+
+    pairs_.clear();
+    pair_indexes_.clear();
+
+    // Sweep the x axis once, keeping the boxes whose interval is still open.
+    auto& active = active_boxes_;
+    active.clear();
+
+    for (const auto& endpoint : endpoints_[0]) {
+        const int boxIndex = endpoint.GetBox();
+
+        if (endpoint.IsMax()) {
+            active.erase(std::find(active.begin(), active.end(), boxIndex));
+            continue;
+        }
+
+        for (const auto other : active) {
+            if (boxes_[boxIndex].bounds.Overlaps(boxes_[other].bounds)) {
+                AddPair(boxIndex, other);
+            }
+        }
+
+        active.push_back(boxIndex);
+    }
+}
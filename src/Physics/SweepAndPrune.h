@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "./BroadPhase.h"
+
+/**
+ * An incremental sweep and prune broad phase. The endpoint arrays of both axes
+ * are kept sorted across frames and re-sorted with an insertion sort, which is
+ * close to linear when colliders only move a little. The set of overlapping
+ * pairs is updated from the endpoint swaps instead of being rebuilt.
+ */
+class SweepAndPrune : public IBroadPhase {
+   private:
+    struct Endpoint {
+        float value;
+        // Box index shifted left by one, the low bit is set for max endpoints.
+        uint32_t data;
+
+        int GetBox() const {
+            return static_cast<int>(data >> 1);
+        }
+
+        bool IsMax() const {
+            return (data & 1) != 0;
+        }
+    };
+
+    struct Box {
+        int entityId;
+        int proxy;
+        AABB bounds;
+        bool isSeen;
+    };
+
+    std::vector<Box> boxes_;
+    std::vector<int> free_boxes_;
+    std::vector<int> box_by_entity_;
+    std::vector<Endpoint> endpoints_[2];
+
+    // Overlapping pairs of box indexes, stored densely so removal is a swap.
+    std::vector<uint64_t> pairs_;
+    std::unordered_map<uint64_t, int> pair_indexes_;
+
+    std::vector<int> added_boxes_;
+    std::vector<int> removed_boxes_;
+    std::vector<int> active_boxes_;
+
+    static uint64_t MakePairKey(int boxA, int boxB);
+    static bool ShouldSwap(const Endpoint& previous, const Endpoint& current);
+
+    int AddBox(const ColliderProxy& proxy, int proxyIndex);
+    void RemoveBoxes();
+    void AddPair(int boxA, int boxB);
+    void RemovePair(int boxA, int boxB);
+    void InsertionSort(int axis);
+    void Rebuild();
+    float GetEndpointValue(const Endpoint& endpoint, int axis) const;
+
+   public:
+    SweepAndPrune() = default;
+    ~SweepAndPrune() = default;
+
+    void FindPairs(const std::vector<ColliderProxy>& proxies, std::vector<CollisionPair>& pairs) override;
+};
@@ -0,0 +1,155 @@
+#include "TileGrid.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+// Keeps boxes resting exactly on a cell border out of the next cell despite
+// rounding.
+const float kCellEpsilon = 1e-4f;
+
+TileGrid::TileGrid() : columns_(0), rows_(0), tile_size_(0.0f), inverse_tile_size_(0.0f), flags_() {
+}
+
+void TileGrid::Reset(int columns, int rows, float tileSize) {
+    columns_ = columns;
+    rows_ = rows;
+    tile_size_ = tileSize;
+    inverse_tile_size_ = 1.0f / tileSize;
+    flags_.assign(columns * rows, 0);
+}
+
+void TileGrid::Clear() {
+    columns_ = 0;
+    rows_ = 0;
+    flags_.clear();
+}
+
+void TileGrid::SetFlags(int column, int row, uint8_t flags) {
+    if (column < 0 || row < 0 || column >= columns_ || row >= rows_) {
+        return;
+    }
+    flags_[row * columns_ + column] = flags;
+}
+
+int TileGrid::ToCell(float value) const {
+    return static_cast<int>(std::floor(value * inverse_tile_size_));
+}
+
+int TileGrid::ToLastCell(float value) const {
+    return static_cast<int>(std::ceil(value * inverse_tile_size_ - kCellEpsilon)) - 1;
+}
+
+bool TileGrid::Overlaps(const AABB& box, uint8_t mask) const {
+    if (IsEmpty()) {
+        return false;
+    }
+
+    const int lastColumn = ToLastCell(box.max.x);
+    const int lastRow = ToLastCell(box.max.y);
+
+    for (int row = ToCell(box.min.y); row <= lastRow; row++) {
+        for (int column = ToCell(box.min.x); column <= lastColumn; column++) {
+            if (GetFlags(column, row) & mask) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Checks the line of cells at index cell along axis, from first to last on the
+// other axis.
+bool TileGrid::IsRangeBlocked(int axis, int cell, int first, int last, uint8_t mask) const {
+    for (int i = first; i <= last; i++) {
+        const uint8_t flags = axis == 0 ? GetFlags(cell, i) : GetFlags(i, cell);
+        if (flags & mask) {
+            return true;
+        }
+    }
+    return false;
+}
+
+float TileGrid::SweepAxis(const AABB& box, int axis, float delta, uint8_t mask) const {
+    const int other = 1 - axis;
+    const int first = ToCell(box.min[other]);
+    const int last = ToLastCell(box.max[other]);
+
+    if (delta > 0.0f) {
+        const int from = ToLastCell(box.max[axis]) + 1;
+        const int to = ToLastCell(box.max[axis] + delta);
+        for (int cell = from; cell <= to; cell++) {
+            if (IsRangeBlocked(axis, cell, first, last, mask)) {
+                return cell * tile_size_ - box.max[axis];
+            }
+        }
+    } else if (delta < 0.0f) {
+        const int from = ToCell(box.min[axis]) - 1;
+        const int to = ToCell(box.min[axis] + delta);
+        for (int cell = from; cell >= to; cell--) {
+            if (IsRangeBlocked(axis, cell, first, last, mask)) {
+                return (cell + 1) * tile_size_ - box.min[axis];
+            }
+        }
+    }
+
+    return delta;
+}
+
+glm::vec2 TileGrid::Sweep(const AABB& box, glm::vec2 delta, uint8_t mask) const {
+    if (IsEmpty()) {
+        return delta;
+    }
+
+    glm::vec2 allowed;
+    allowed.x = SweepAxis(box, 0, delta.x, mask);
+
+    const glm::vec2 movedX(allowed.x, 0.0f);
+    allowed.y = SweepAxis(AABB(box.min + movedX, box.max + movedX), 1, delta.y, mask);
+    return allowed;
+}
+
+bool TileGrid::Raycast(glm::vec2 from, glm::vec2 to, uint8_t mask, float& fraction) const {
+    if (IsEmpty()) {
+        return false;
+    }
+
+    // Amanatides and Woo: step into whichever cell border the ray reaches next.
+    const glm::vec2 start = from * inverse_tile_size_;
+    const glm::vec2 delta = (to - from) * inverse_tile_size_;
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    int column = static_cast<int>(std::floor(start.x));
+    int row = static_cast<int>(std::floor(start.y));
+    const int endColumn = static_cast<int>(std::floor(start.x + delta.x));
+    const int endRow = static_cast<int>(std::floor(start.y + delta.y));
+    const int stepX = delta.x > 0.0f ? 1 : (delta.x < 0.0f ? -1 : 0);
+    const int stepY = delta.y > 0.0f ? 1 : (delta.y < 0.0f ? -1 : 0);
+
+    const float tDeltaX = stepX != 0 ? 1.0f / std::abs(delta.x) : infinity;
+    const float tDeltaY = stepY != 0 ? 1.0f / std::abs(delta.y) : infinity;
+    float tMaxX = stepX > 0 ? (column + 1 - start.x) * tDeltaX : (stepX < 0 ? (start.x - column) * tDeltaX : infinity);
+    float tMaxY = stepY > 0 ? (row + 1 - start.y) * tDeltaY : (stepY < 0 ? (start.y - row) * tDeltaY : infinity);
+
+    const int steps = std::abs(endColumn - column) + std::abs(endRow - row);
+    float t = 0.0f;
+
+    for (int i = 0; i <= steps; i++) {
+        if (GetFlags(column, row) & mask) {
+            fraction = t;
+            return true;
+        }
+
+        if (tMaxX < tMaxY) {
+            t = tMaxX;
+            tMaxX += tDeltaX;
+            column += stepX;
+        } else {
+            t = tMaxY;
+            tMaxY += tDeltaY;
+            row += stepY;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "./AABB.h"
+
+// Collision flags stored per map cell.
+enum TileFlags : uint8_t {
+    TILE_SOLID = 1u << 0,
+    TILE_BLOCKS_PROJECTILES = 1u << 1
+};
+
+/**
+ * The collision flags of every map tile in one byte per cell, so terrain can be
+ * collided against without an entity or collider per tile. The grid starts at
+ * the world origin. Cells outside the map have no flags.
+ */
+class TileGrid {
+   private:
+    int columns_;
+    int rows_;
+    float tile_size_;
+    float inverse_tile_size_;
+    std::vector<uint8_t> flags_;
+
+    int ToCell(float value) const;
+    // The last cell a max edge overlaps. An edge exactly on a cell border does
+    // not overlap the next cell.
+    int ToLastCell(float value) const;
+    bool IsRangeBlocked(int axis, int cell, int first, int last, uint8_t mask) const;
+    float SweepAxis(const AABB& box, int axis, float delta, uint8_t mask) const;
+
+   public:
+    TileGrid();
+    ~TileGrid() = default;
+
+    // Clears the grid to the given size with no flags set.
+    void Reset(int columns, int rows, float tileSize);
+
+    void Clear();
+
+    bool IsEmpty() const {
+        return flags_.empty();
+    }
+
+    float GetTileSize() const {
+        return tile_size_;
+    }
+
+    void SetFlags(int column, int row, uint8_t flags);
+
+    uint8_t GetFlags(int column, int row) const {
+        if (column < 0 || row < 0 || column >= columns_ || row >= rows_) {
+            return 0;
+        }
+        return flags_[row * columns_ + column];
+    }
+
+    uint8_t GetFlagsAt(glm::vec2 position) const {
+        return GetFlags(ToCell(position.x), ToCell(position.y));
+    }
+
+    // Returns true if the box overlaps a cell with any of the mask flags.
+    bool Overlaps(const AABB& box, uint8_t mask) const;
+
+    // Moves box by delta one axis at a time and returns how far it can go before
+    // entering a cell with any of the mask flags. Every cell the leading edge
+    // crosses is checked, so fast movers cannot skip over thin walls. Cells the
+    // box already overlaps are ignored so it can always move out of them.
+    glm::vec2 Sweep(const AABB& box, glm::vec2 delta, uint8_t mask) const;
+
+    // Walks the cells along the segment from -> to. On a hit, fraction is how
+    // far along the segment the first cell with any of the mask flags starts.
+    bool Raycast(glm::vec2 from, glm::vec2 to, uint8_t mask, float& fraction) const;
+};
@@ -15,18 +15,28 @@
 #include "../Components/TransformComponent.h"
 #include "../ECS/ECS.h"
 #include "../General/Logger.h"
+#include "../General/Profiler.h"
 #include "./RenderKey.h"
 #include "./RenderQueue.h"
 #include "./RenderableType.h"
 
-void Renderer::Render(const RenderQueue& renderQueue, SDL_Renderer* renderer, SDL_Rect& camera, std::unique_ptr<AssetManager>& assetManager) {
-    for (const RenderKey& renderKey : renderQueue) {
+void Renderer::Render(const RenderQueue& renderQueue, SDL_Renderer* renderer, SDL_Rect& camera, std::unique_ptr<AssetManager>& assetManager, float alpha, unsigned int firstLayer, unsigned int endLayer) {
+    PROFILE_SCOPE("Renderer");
+
+    const auto isBelow = [](const RenderKey& key, unsigned int layer) {
+        return key.layer < layer;
+    };
+    const auto first = std::lower_bound(renderQueue.begin(), renderQueue.end(), firstLayer, isBelow);
+    const auto last = std::lower_bound(first, renderQueue.end(), endLayer, isBelow);
+
+    for (auto it = first; it != last; ++it) {
+        const RenderKey& renderKey = *it;
         const Entity entity = renderKey.entity;
         const RenderableType type = renderKey.type;
 
         switch (type) {
             case RenderableType::SPRITE:
-                RenderSprite(entity, renderer, assetManager, camera);
+                RenderSprite(entity, renderer, assetManager, camera, alpha);
                 break;
             case RenderableType::TEXT:
                 RenderText(entity, renderer, assetManager, camera);
@@ -41,13 +51,14 @@ void Renderer::Render(const RenderQueue& renderQueue, SDL_Renderer* renderer, SD
     }
 }
 
-void Renderer::RenderSprite(const Entity& entity, SDL_Renderer* renderer, std::unique_ptr<AssetManager>& assetManager, SDL_Rect& camera) {
+void Renderer::RenderSprite(const Entity& entity, SDL_Renderer* renderer, std::unique_ptr<AssetManager>& assetManager, SDL_Rect& camera, float alpha) {
     const auto transform = entity.GetComponent<TransformComponent>();
     const auto sprite = entity.GetComponent<SpriteComponent>();
 
     const auto texture = assetManager->GetTexture(sprite.assetId);
-    float x = sprite.isFixed ? transform.position.x : transform.position.x - camera.x;
-    float y = sprite.isFixed ? transform.position.y : transform.position.y - camera.y;
+    const auto position = transform.GetInterpolatedPosition(alpha);
+    float x = sprite.isFixed ? position.x : position.x - camera.x;
+    float y = sprite.isFixed ? position.y : position.y - camera.y;
 
     SDL_Rect destRect = {
         static_cast<int>(x),
@@ -55,7 +66,7 @@ void Renderer::RenderSprite(const Entity& entity, SDL_Renderer* renderer, std::u
         static_cast<int>(sprite.width * transform.scale.x),
         static_cast<int>(sprite.height * transform.scale.y)};
 
-    SDL_RenderCopyEx(renderer, texture, &sprite.srcRect, &destRect, transform.rotation, nullptr, sprite.flip);
+    SDL_RenderCopyEx(renderer, texture, &sprite.srcRect, &destRect, transform.GetInterpolatedRotation(alpha), nullptr, sprite.flip);
 }
 
 void Renderer::RenderSquare(const Entity& entity, SDL_Renderer* renderer, SDL_Rect& camera) {
@@ -74,6 +85,8 @@ void Renderer::RenderSquare(const Entity& entity, SDL_Renderer* renderer, SDL_Re
 }
 
 void Renderer::RenderText(const Entity& entity, SDL_Renderer* renderer, std::unique_ptr<AssetManager>& assetManager, SDL_Rect& camera) {
+    // Text is rasterized again every frame, so it gets its own marker.
+    PROFILE_SCOPE("Renderer text");
     const auto textLabel = entity.GetComponent<TextLabelComponent>();
     const auto font = assetManager->GetFont(textLabel.fontId);
     SDL_Surface* surface = TTF_RenderText_Blended(
@@ -2,6 +2,8 @@
 
 #include <SDL2/SDL.h>
 
+#include <climits>
+
 #include "../AssetManager/AssetManager.h"
 #include "./RenderQueue.h"
 
@@ -10,10 +12,14 @@ class Renderer {
     Renderer() = default;
     ~Renderer() = default;
 
-    void Render(const RenderQueue& renderQueue, SDL_Renderer* renderer, SDL_Rect& camera, std::unique_ptr<AssetManager>& assetManager);
+    // Sprites are drawn alpha of the way from their previous tick's transform
+    // to their current one. Only layers from firstLayer up to, but not
+    // including, endLayer are drawn, so other passes can go between them. The
+    // queue must be sorted.
+    void Render(const RenderQueue& renderQueue, SDL_Renderer* renderer, SDL_Rect& camera, std::unique_ptr<AssetManager>& assetManager, float alpha, unsigned int firstLayer = 0, unsigned int endLayer = UINT_MAX);
 
    private:
-    void RenderSprite(const Entity& entity, SDL_Renderer* renderer, std::unique_ptr<AssetManager>& assetManager, SDL_Rect& camera);
+    void RenderSprite(const Entity& entity, SDL_Renderer* renderer, std::unique_ptr<AssetManager>& assetManager, SDL_Rect& camera, float alpha);
     void RenderSquare(const Entity& entity, SDL_Renderer* renderer, SDL_Rect& camera);
     void RenderText(const Entity& entity, SDL_Renderer* renderer, std::unique_ptr<AssetManager>& assetManager, SDL_Rect& camera);
 };
\ No newline at end of file
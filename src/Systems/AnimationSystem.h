@@ -5,11 +5,15 @@
 #include "../Components/AnimationComponent.h"
 #include "../Components/SpriteComponent.h"
 #include "../ECS/ECS.h"
+#include "../General/FrameClock.h"
 #include "../General/Logger.h"
 
 class AnimationSystem : public System {
+   private:
+    const FrameClock& clock_;
+
    public:
-    AnimationSystem() {
+    AnimationSystem(const FrameClock& clock) : clock_(clock) {
         RequireComponent<SpriteComponent>();
         RequireComponent<AnimationComponent>();
     }
@@ -17,15 +21,31 @@ class AnimationSystem : public System {
     ~AnimationSystem() = default;
 
     void Update() {
-        for (auto entity : GetEntities()) {
+        UpdatePart(0, 1);
+    }
+
+    // Frames are picked from the clock, so a part that is skipped for a few
+    // frames catches up as soon as it runs.
+    void UpdatePart(int part, int partCount) override {
+        const double time = clock_.GetTime();
+        const auto& entities = GetEntities();
+
+        for (auto entity : entities) {
+            if (entity.GetId() % partCount != part) {
+                continue;
+            }
+
             auto& animation = entity.GetComponent<AnimationComponent>();
             auto& sprite = entity.GetComponent<SpriteComponent>();
 
-            animation.currentFrame = (
-                (SDL_GetTicks() - animation.startTime) 
-                    * animation.frameRateSpeed / 1000) % animation.numFrames;
+            if (animation.startTime < 0.0) {
+                animation.startTime = time;
+            }
+
+            animation.currentFrame = static_cast<int>(
+                (time - animation.startTime) * animation.frameRateSpeed) % animation.numFrames;
             sprite.srcRect.x = animation.currentFrame * sprite.width;
             //sprite.srcRect.y = animation.currentFrame * sprite.height;
         }
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include <memory>
+#include <vector>
+
+#include "../AssetManager/AssetManager.h"
+#include "../Bullets/BulletManager.h"
+#include "../Components/BoxColliderComponent.h"
+#include "../Components/HealthComponent.h"
+#include "../Components/TransformComponent.h"
+#include "../ECS/ECS.h"
+#include "../Physics/TileGrid.h"
+#include "./CollisionSystem.h"
+
+// Bullets are drawn after the sprites of this layer and before any higher
+// layer, where projectile sprites used to be, so health bars and UI stay on
+// top.
+const unsigned int kBulletRenderLayer = 4;
+
+/**
+ * Runs the bullet manager against the entities that can take damage. The
+ * player is hit by enemy bullets and enemies by the player's. Bullets are not
+ * entities, so they never reach the collision system.
+ */
+class BulletSystem : public System {
+   private:
+    BulletManager bullets_;
+    const TileGrid& tile_grid_;
+    // The entity behind each bullet target, by target index.
+    std::vector<Entity> targets_;
+    std::vector<BulletHit> hits_;
+
+   public:
+    BulletSystem(const TileGrid& tileGrid) : bullets_(), tile_grid_(tileGrid), targets_(), hits_() {
+        RequireComponent<TransformComponent>();
+        RequireComponent<BoxColliderComponent>();
+        RequireComponent<HealthComponent>();
+    }
+
+    ~BulletSystem() = default;
+
+    BulletManager& GetBullets() {
+        return bullets_;
+    }
+
+    void Update(double deltaTime) {
+        bullets_.ClearTargets();
+        targets_.clear();
+
+        for (auto entity : GetEntities()) {
+            BulletFaction faction;
+
+            if (entity.HasTag("player")) {
+                faction = BulletFaction::FACTION_PLAYER;
+            } else if (entity.InGroup("enemies")) {
+                faction = BulletFaction::FACTION_ENEMIES;
+            } else {
+                continue;
+            }
+
+            const auto& transform = entity.GetComponent<TransformComponent>();
+            const auto& collider = entity.GetComponent<BoxColliderComponent>();
+            bullets_.AddTarget(CollisionSystem::GetColliderBounds(transform, collider), faction);
+            targets_.push_back(entity);
+        }
+
+        hits_.clear();
+        const AABB worldBounds(glm::vec2(0), glm::vec2(Game::mapWidth, Game::mapHeight));
+        bullets_.Update(static_cast<float>(deltaTime), tile_grid_, worldBounds, hits_);
+
+        for (const auto& hit : hits_) {
+            auto target = targets_[hit.target];
+            auto& health = target.GetComponent<HealthComponent>();
+
+            // Only the hit that finishes the target destroys it.
+            const bool wasAlive = health.currentHealth > 0;
+            health.currentHealth -= hit.damage;
+
+            if (wasAlive && health.currentHealth <= 0) {
+                target.Blam();
+            }
+        }
+    }
+
+    // Bullets have no previous position, so they are drawn back along their
+    // velocity by the part of a tick the frame has not reached yet.
+    void Render(SDL_Renderer* renderer, SDL_Rect& camera, std::unique_ptr<AssetManager>& assetManager, float alpha, double tickDeltaTime) {
+        const float timeOffset = static_cast<float>((alpha - 1.0) * tickDeltaTime);
+        bullets_.Render(renderer, assetManager->GetTexture("bullet-texture"), camera, timeOffset);
+    }
+};
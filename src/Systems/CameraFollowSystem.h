@@ -14,16 +14,17 @@ class CameraFollowSystem : public System {
         RequireComponent<TransformComponent>();
     }
 
-    void Update(SDL_Rect& camera) {
+    // Follows where the entity is drawn, alpha of the way between ticks.
+    void Update(SDL_Rect& camera, float alpha) {
         for (auto entity : GetEntities()) {
-            auto transform = entity.GetComponent<TransformComponent>();
+            const auto position = entity.GetComponent<TransformComponent>().GetInterpolatedPosition(alpha);
 
-            if (transform.position.x + (camera.w / 2) < Game::mapWidth) {
-                camera.x = transform.position.x - (Game::windowWidth / 2);
+            if (position.x + (camera.w / 2) < Game::mapWidth) {
+                camera.x = position.x - (Game::windowWidth / 2);
             }
 
-            if (transform.position.y + (camera.h / 2) < Game::mapHeight) {
-                camera.y = transform.position.y - (Game::windowHeight / 2);
+            if (position.y + (camera.h / 2) < Game::mapHeight) {
+                camera.y = position.y - (Game::windowHeight / 2);
             }
 
             camera.x = std::max(0, camera.x);
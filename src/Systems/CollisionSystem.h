@@ -1,43 +1,158 @@
 #pragma once
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "../Components/BoxColliderComponent.h"
+#include "../Components/RigidBodyComponent.h"
 #include "../Components/TransformComponent.h"
 #include "../ECS/ECS.h"
 #include "../EventBus/EventBus.h"
 #include "../Events/CollisionEvent.h"
 #include "../General/Logger.h"
+#include "../Physics/AABB.h"
+#include "../Physics/AABBTreeBroadPhase.h"
+#include "../Physics/BroadPhase.h"
+#include "../Physics/BruteForceBroadPhase.h"
+#include "../Physics/ColliderSoA.h"
+#include "../Physics/ContactCache.h"
+#include "../Physics/SpatialHashGrid.h"
+#include "../Physics/SweepAndPrune.h"
+
+// Pair and contact lists start with room for this many, so the first
+// collisions of a level do not grow them mid-frame.
+const int kInitialPairCapacity = 256;
 
 class CollisionSystem : public System {
+   private:
+    BroadPhaseType broad_phase_type_;
+    float cell_size_;
+    std::unique_ptr<IBroadPhase> broad_phase_;
+
+    // Rebuilt every frame, kept as members so their capacity is reused.
+    std::vector<ColliderProxy> proxies_;
+    ColliderSoA colliders_;
+    std::vector<CollisionPair> pairs_;
+    std::vector<CollisionPair> overlapping_pairs_;
+    ContactCache contact_cache_;
+    std::vector<Contact> contacts_;
+
    public:
-    CollisionSystem() {
+    // The grid is the default as it scales best on our scenes, see make bench.
+    CollisionSystem(BroadPhaseType broadPhaseType = SPATIAL_HASH, float cellSize = kDefaultCellSize)
+        : broad_phase_type_(), cell_size_(cellSize), broad_phase_(), proxies_(), colliders_(), pairs_(), overlapping_pairs_(), contact_cache_(), contacts_() {
         RequireComponent<TransformComponent>();
         RequireComponent<BoxColliderComponent>();
+        pairs_.reserve(kInitialPairCapacity);
+        overlapping_pairs_.reserve(kInitialPairCapacity);
+        contacts_.reserve(kInitialPairCapacity);
+        SetBroadPhase(broadPhaseType);
     }
 
     ~CollisionSystem() = default;
 
+    BroadPhaseType GetBroadPhaseType() const {
+        return broad_phase_type_;
+    }
+
+    // Swaps the broad phase. Persistent broad phases rebuild their state from
+    // the colliders on the next update.
+    void SetBroadPhase(BroadPhaseType broadPhaseType) {
+        broad_phase_type_ = broadPhaseType;
+
+        switch (broadPhaseType) {
+            case BroadPhaseType::BRUTE_FORCE:
+                broad_phase_ = std::make_unique<BruteForceBroadPhase>();
+                break;
+            case BroadPhaseType::SWEEP_AND_PRUNE:
+                broad_phase_ = std::make_unique<SweepAndPrune>();
+                break;
+            case BroadPhaseType::AABB_TREE:
+                broad_phase_ = std::make_unique<AABBTreeBroadPhase>();
+                break;
+            case BroadPhaseType::SPATIAL_HASH:
+            default:
+                broad_phase_type_ = BroadPhaseType::SPATIAL_HASH;
+                broad_phase_ = std::make_unique<SpatialHashGrid>(cell_size_);
+                break;
+        }
+    }
+
+    void SetCellSize(float cellSize) {
+        cell_size_ = cellSize;
+
+        if (broad_phase_type_ == BroadPhaseType::SPATIAL_HASH) {
+            static_cast<SpatialHashGrid&>(*broad_phase_).SetCellSize(cellSize);
+        }
+    }
+
+    static BroadPhaseType GetBroadPhaseType(const std::string& name) {
+        if (name == "brute_force") {
+            return BroadPhaseType::BRUTE_FORCE;
+        }
+        if (name == "sweep_and_prune") {
+            return BroadPhaseType::SWEEP_AND_PRUNE;
+        }
+        if (name == "aabb_tree") {
+            return BroadPhaseType::AABB_TREE;
+        }
+        if (name != "spatial_hash") {
+            Logger::Warn("Unknown broad phase: " + name + ". Using spatial_hash.");
+        }
+        return BroadPhaseType::SPATIAL_HASH;
+    }
+
     void Update(std::unique_ptr<EventBus>& eventBus) {
-        auto entities = GetEntities();
-
-        for (auto i = entities.begin(); i != entities.end(); i++) {
-            auto entityA = *i;
-            const auto& transformA = entityA.GetComponent<TransformComponent>();
-            const auto& colliderA = entityA.GetComponent<BoxColliderComponent>();
-
-            for (auto j = i + 1; j != entities.end(); j++) {
-                auto entityB = *j;
-                const auto& transformB = entityB.GetComponent<TransformComponent>();
-                const auto& colliderB = entityB.GetComponent<BoxColliderComponent>();
-                bool isColliding = CheckAABBCollision(transformA, colliderA, transformB, colliderB);
-                if (isColliding) {
-                    eventBus->EmitEvent<CollisionEvent>(entityA, entityB);
-                }
+        proxies_.clear();
+        colliders_.Clear();
+        pairs_.clear();
+        overlapping_pairs_.clear();
+
+        // World space bounds are computed once per collider and shared by the
+        // broad phase and the packed arrays the narrow phase runs on.
+        for (auto entity : GetEntities()) {
+            const auto& transform = entity.GetComponent<TransformComponent>();
+            const auto& collider = entity.GetComponent<BoxColliderComponent>();
+            const AABB bounds = GetColliderBounds(transform, collider);
+            // Colliders without a rigid body are not expected to move, and
+            // sleeping bodies will not until they are woken.
+            const bool isStatic = !entity.HasComponent<RigidBodyComponent>() || entity.GetComponent<RigidBodyComponent>().isSleeping;
+            proxies_.emplace_back(entity, bounds, isStatic, collider.category, collider.collidesWith);
+            colliders_.Add(bounds, collider.category, collider.collidesWith);
+        }
+
+        broad_phase_->FindPairs(proxies_, pairs_);
+        colliders_.FilterOverlapping(pairs_, overlapping_pairs_);
+        contact_cache_.Update(proxies_, overlapping_pairs_, contacts_);
+
+        // Systems in the engine read the contacts directly. The event is only
+        // queued once per contact for anything else listening, and is handled
+        // in one batch when the game flushes it.
+        for (const auto& contact : contacts_) {
+            if (contact.phase == ContactPhase::CONTACT_BEGIN) {
+                eventBus->QueueEvent<CollisionEvent>(contact.entityA, contact.entityB);
             }
         }
     }
 
-    bool CheckAABBCollision(const TransformComponent& transformA, const BoxColliderComponent& colliderA, const TransformComponent& transformB, const BoxColliderComponent& colliderB) {
-        return !(
-            (transformA.position.x > (transformB.position.x + colliderB.width * transformB.scale.x)) || ((transformA.position.x + colliderA.width * transformA.scale.x) < transformB.position.x) || ((transformA.position.y + colliderA.height * transformA.scale.y) < transformB.position.y) || (transformA.position.y > (transformB.position.y + colliderB.height * transformB.scale.y)));
+    // The overlapping pairs of the last update as indexes into the colliders.
+    const std::vector<CollisionPair>& GetOverlappingPairs() const {
+        return overlapping_pairs_;
+    }
+
+    // The contacts that began, stayed or ended in the last update.
+    const std::vector<Contact>& GetContacts() const {
+        return contacts_;
+    }
+
+    // The offset is in world units and is not scaled with the transform.
+    static AABB GetColliderBounds(const TransformComponent& transform, const BoxColliderComponent& collider) {
+        const glm::vec2 min = transform.position + collider.offset;
+        return AABB(
+            min,
+            glm::vec2(
+                min.x + collider.width * transform.scale.x,
+                min.y + collider.height * transform.scale.y));
     }
-};
\ No newline at end of file
+};
@@ -2,6 +2,8 @@
 
 #include <SDL2/SDL.h>
 
+#include <cstdio>
+
 #include "../Components/HealthComponent.h"
 #include "../Components/SpriteComponent.h"
 #include "../Components/SquarePrimitiveComponent.h"
@@ -9,32 +11,59 @@
 #include "../Components/TransformComponent.h"
 #include "../ECS/ECS.h"
 
+/**
+ * Keeps a health label and bar over every entity with health. The text and
+ * bar width can run a few frames behind, so that update is split into parts
+ * the frame scheduler can spread over frames. Positions follow the entity
+ * every frame.
+ */
 class DisplayHealthSystem : public System {
    private:
+    Registry& registry_;
     std::unordered_map<int, std::shared_ptr<Entity>> health_trackers_;
-    std::set<int> living_entities_;
-    std::set<int> removed_entities_;
+    // Trackers of removed entities, destroyed on the next update since
+    // entities cannot be destroyed while the registry is removing others.
+    std::vector<std::shared_ptr<Entity>> removed_trackers_;
     SDL_Color low_health_color = {255, 0, 0};
     SDL_Color medium_health_color = {255, 255, 0};
     SDL_Color high_health_color = {0, 255, 0};
 
    public:
-    DisplayHealthSystem() : health_trackers_(), living_entities_(), removed_entities_() {
+    DisplayHealthSystem(Registry& registry) : registry_(registry), health_trackers_(), removed_trackers_() {
         RequireComponent<HealthComponent>();
         RequireComponent<TransformComponent>();
     }
 
     ~DisplayHealthSystem() = default;
 
-    void Update(std::unique_ptr<Registry>& registry) {
-        living_entities_.clear();
-        removed_entities_.clear();
+    void OnEntityRemoved(Entity entity) override {
+        auto it = health_trackers_.find(entity.GetId());
 
-        for (auto entity : GetEntities()) {
-            living_entities_.emplace(entity.GetId());
+        if (it != health_trackers_.end()) {
+            removed_trackers_.push_back(it->second);
+            health_trackers_.erase(it);
+        }
+    }
+
+    void Update() {
+        UpdatePart(0, 1);
+    }
+
+    void UpdatePart(int part, int partCount) override {
+        for (auto& tracker : removed_trackers_) {
+            tracker->Blam();
+        }
+        removed_trackers_.clear();
+
+        const auto& entities = GetEntities();
+
+        for (const auto entity : entities) {
+            if (entity.GetId() % partCount != part) {
+                continue;
+            }
 
             if (health_trackers_.find(entity.GetId()) == health_trackers_.end()) {
-                CreateHealthTracker(registry, entity.GetId());
+                CreateHealthTracker(entity.GetId());
             }
 
             auto transform = entity.GetComponent<TransformComponent>();
@@ -44,8 +73,13 @@ class DisplayHealthSystem : public System {
 
             float healthPercentage = static_cast<float>(health.currentHealth) / health.maxHealth;
             int healthAmount = static_cast<int>(healthPercentage * 100);
-            textLabel.text = std::to_string(healthAmount) + "%";
-            textLabel.position = glm::vec2(transform.position.x, transform.position.y - 25);
+            // Only reassign the text when the amount changes, so an unchanged
+            // label costs no string work.
+            char text[8];
+            std::snprintf(text, sizeof(text), "%d%%", healthAmount);
+            if (textLabel.text != text) {
+                textLabel.text = text;
+            }
             textLabel.color = GetHealthColor(healthPercentage);
 
             int healthWidth = healthAmount;
@@ -55,27 +89,30 @@ class DisplayHealthSystem : public System {
                 healthWidth = static_cast<int>(sprite.width * healthPercentage * transform.scale.x);
             }
 
-            square.position = glm::vec2(transform.position.x, transform.position.y - 5);
             square.width = healthWidth;
             square.color = GetHealthColor(healthPercentage);
         }
+    }
 
-        for (auto healthTracker : health_trackers_) {
-            if (living_entities_.find(healthTracker.first) == living_entities_.end()) {
-                healthTracker.second->Blam();
-                living_entities_.erase(healthTracker.first);
-                removed_entities_.emplace(healthTracker.first);
+    // Puts each label and bar over its entity where the entity's sprite is
+    // drawn this frame. Only the text and width may be stale, so unlike
+    // UpdatePart this runs every rendered frame.
+    void FollowEntities(float alpha) {
+        for (auto entity : GetEntities()) {
+            auto tracker = health_trackers_.find(entity.GetId());
+            if (tracker == health_trackers_.end()) {
+                continue;
             }
-        }
 
-        for (auto entityId : removed_entities_) {
-            health_trackers_.erase(entityId);
+            const auto position = entity.GetComponent<TransformComponent>().GetInterpolatedPosition(alpha);
+            tracker->second->GetComponent<TextLabelComponent>().position = glm::vec2(position.x, position.y - 25);
+            tracker->second->GetComponent<SquarePrimitiveComponent>().position = glm::vec2(position.x, position.y - 5);
         }
     }
 
    private:
-    void CreateHealthTracker(std::unique_ptr<Registry>& registry, int entityId) {
-        auto healthTracker = registry->CreateEntity();
+    void CreateHealthTracker(int entityId) {
+        auto healthTracker = registry_.CreateEntity();
         healthTracker.AddComponent<TextLabelComponent>(glm::vec2(0, 0), 100, "100", "arial-font-10", SDL_Color{255, 255, 255}, false);
         healthTracker.AddComponent<SquarePrimitiveComponent>(glm::vec2(0, 0), 100, 100, 10, SDL_Color{255, 0, 0}, false);
         health_trackers_[entityId] = std::make_shared<Entity>(healthTracker);
@@ -6,6 +6,7 @@
 #include "../Components/TransformComponent.h"
 #include "../ECS/ECS.h"
 #include "../General/Logger.h"
+#include "./CollisionSystem.h"
 
 class DrawColliderSystem : public System {
    public:
@@ -20,12 +21,13 @@ class DrawColliderSystem : public System {
         for (auto entity : GetEntities()) {
             const auto& transform = entity.GetComponent<TransformComponent>();
             const auto& collider = entity.GetComponent<BoxColliderComponent>();
+            const AABB bounds = CollisionSystem::GetColliderBounds(transform, collider);
 
             const SDL_FRect rect = {
-                transform.position.x - camera.x,
-                transform.position.y - camera.y,
-                collider.width * transform.scale.x,
-                collider.height * transform.scale.y};
+                bounds.min.x - camera.x,
+                bounds.min.y - camera.y,
+                bounds.max.x - bounds.min.x,
+                bounds.max.y - bounds.min.y};
 
             SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
             SDL_RenderDrawRectF(renderer, &rect);
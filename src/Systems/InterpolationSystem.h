@@ -0,0 +1,26 @@
+#pragma once
+
+#include "../Components/TransformComponent.h"
+#include "../ECS/ECS.h"
+
+/**
+ * Remembers every transform at the start of each simulation tick. Rendering
+ * runs between ticks and draws entities part way from that to where the tick
+ * left them.
+ */
+class InterpolationSystem : public System {
+   public:
+    InterpolationSystem() {
+        RequireComponent<TransformComponent>();
+    }
+
+    ~InterpolationSystem() = default;
+
+    void SavePreviousTransforms() {
+        for (auto entity : GetEntities()) {
+            auto& transform = entity.GetComponent<TransformComponent>();
+            transform.previousPosition = transform.position;
+            transform.previousRotation = transform.rotation;
+        }
+    }
+};
@@ -13,8 +13,11 @@
 #include "../General/Logger.h"
 
 class KeyboardControlSystem : public System {
+   private:
+    EventSubscription key_input_subscription_;
+
    public:
-    KeyboardControlSystem() {
+    KeyboardControlSystem() : key_input_subscription_() {
         RequireComponent<KeyboardControlComponent>();
         RequireComponent<RigidBodyComponent>();
         RequireComponent<SpriteComponent>();
@@ -23,10 +26,10 @@ class KeyboardControlSystem : public System {
     ~KeyboardControlSystem() = default;
 
     void SubscribeToEvents(std::unique_ptr<EventBus>& eventBus) {
-        eventBus->SubscribeEvent<KeyboardControlSystem, KeyInputEvent>(this, &KeyboardControlSystem::OnKeyInput);
+        key_input_subscription_ = eventBus->SubscribeEvent<KeyboardControlSystem, KeyInputEvent>(this, &KeyboardControlSystem::OnKeyInput);
     }
 
-    void OnKeyInput(KeyInputEvent& event) {
+    void OnKeyInput(const KeyInputEvent& event) {
         for (auto entity : GetEntities()) {
             auto& keyboardComponent = entity.GetComponent<KeyboardControlComponent>();
             auto& spriteComponent = entity.GetComponent<SpriteComponent>();
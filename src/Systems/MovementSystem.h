@@ -1,36 +1,50 @@
 #pragma once
 
+#include "../Components/BoxColliderComponent.h"
 #include "../Components/RigidBodyComponent.h"
 #include "../Components/SpriteComponent.h"
 #include "../Components/TransformComponent.h"
 #include "../ECS/ECS.h"
 #include "../General/Logger.h"
+#include "../Physics/ContactCache.h"
+#include "../Physics/TileGrid.h"
+#include "./CollisionSystem.h"
 
 class MovementSystem : public System {
+   private:
+    TileGrid tile_grid_;
+
    public:
-    MovementSystem() {
+    MovementSystem() : tile_grid_() {
         RequireComponent<TransformComponent>();
         RequireComponent<RigidBodyComponent>();
     }
 
     ~MovementSystem() = default;
 
-    void SubscribeToEvents(std::unique_ptr<EventBus>& eventBus) {
-        eventBus->SubscribeEvent<MovementSystem, CollisionEvent>(this, &MovementSystem::OnCollision);
+    // The terrain collision grid of the current map, filled by the level loader.
+    TileGrid& GetTileGrid() {
+        return tile_grid_;
     }
 
-    void OnCollision(CollisionEvent& event) {
-        auto a = event.entityA;
-        auto b = event.entityB;
-        auto aId = std::to_string(event.entityA.GetId());
-        auto bId = std::to_string(event.entityB.GetId());
+    // Enemies turn around when they first touch an obstacle. Turning on every
+    // frame of the overlap would flip them back and forth.
+    void ResolveContacts(const std::vector<Contact>& contacts) {
+        for (const auto& contact : contacts) {
+            if (contact.phase != ContactPhase::CONTACT_BEGIN) {
+                continue;
+            }
 
-        if (a.InGroup("enemies") && b.InGroup("obstacles")) {
-            OnObstacleCollision(a);
-        }
+            auto a = contact.entityA;
+            auto b = contact.entityB;
 
-        if (b.InGroup("enemies") && a.InGroup("obstacles")) {
-            OnObstacleCollision(b);
+            if (a.InGroup("enemies") && b.InGroup("obstacles")) {
+                OnObstacleCollision(a);
+            }
+
+            if (b.InGroup("enemies") && a.InGroup("obstacles")) {
+                OnObstacleCollision(b);
+            }
         }
     }
 
@@ -43,9 +57,15 @@ class MovementSystem : public System {
             if (!isPlayer && IsEntityOutsideMap(entity)) {
                 Logger::Info("Entity went outside map " + std::to_string(entity.GetId()));
                 entity.Blam();
-            } else {
-                transform.position.x += rigidBody.velocity.x * deltaTime;
-                transform.position.y += rigidBody.velocity.y * deltaTime;
+            } else if (!rigidBody.IsDynamic()) {
+                // Bodies with mass are moved by the physics system.
+                glm::vec2 delta = rigidBody.velocity * static_cast<float>(deltaTime);
+
+                if (!tile_grid_.IsEmpty() && entity.HasComponent<BoxColliderComponent>()) {
+                    delta = CollideWithTerrain(entity, transform, delta);
+                }
+
+                transform.position += delta;
 
                 if (isPlayer) {
                     auto spriteComponent = entity.GetComponent<SpriteComponent>();
@@ -70,9 +90,26 @@ class MovementSystem : public System {
     }
 
    private:
+    // Bodies slide along solid tiles, and enemies turn around like at
+    // obstacles.
+    glm::vec2 CollideWithTerrain(Entity entity, const TransformComponent& transform, glm::vec2 delta) {
+        const AABB bounds = CollisionSystem::GetColliderBounds(transform, entity.GetComponent<BoxColliderComponent>());
+
+        const glm::vec2 allowed = tile_grid_.Sweep(bounds, delta, TileFlags::TILE_SOLID);
+        if (allowed != delta && entity.InGroup("enemies")) {
+            OnObstacleCollision(entity);
+        }
+        return allowed;
+    }
+
     void OnObstacleCollision(Entity enemy) {
         auto& rigidBody = enemy.GetComponent<RigidBodyComponent>();
 
+        // Enemies with mass bounce off through the physics system.
+        if (rigidBody.IsDynamic()) {
+            return;
+        }
+
         rigidBody.velocity = rigidBody.velocity * -1.0f;
 
         if (enemy.HasComponent<SpriteComponent>()) {
@@ -0,0 +1,424 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "../Components/BoxColliderComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Components/TransformComponent.h"
+#include "../ECS/ECS.h"
+#include "../General/Profiler.h"
+#include "../Physics/AABB.h"
+#include "../Physics/ContactCache.h"
+#include "../Physics/TileGrid.h"
+#include "./CollisionSystem.h"
+
+const int kPhysicsSubsteps = 4;
+const float kSleepVelocity = 4.0f;
+const float kTimeToSleep = 0.5f;
+// Penetration left alone so resting contacts do not jitter.
+const float kPenetrationSlop = 0.5f;
+// Fraction of the remaining penetration pushed out per substep.
+const float kPositionCorrection = 0.4f;
+
+/**
+ * Moves the bodies that have mass and resolves their contacts with impulses.
+ * Bodies touching each other form islands, and an island that has been at rest
+ * long enough goes to sleep as a whole. Sleeping bodies are skipped until
+ * something moving touches them.
+ */
+class PhysicsSystem : public System {
+   private:
+    struct Body {
+        Entity entity;
+        TransformComponent* transform;
+        const BoxColliderComponent* collider;
+        // Null for colliders without a rigid body.
+        RigidBodyComponent* rigidBody;
+        float inverseMass;
+        glm::vec2 velocity;
+    };
+
+    struct ContactConstraint {
+        int bodyA;
+        int bodyB;
+        float restitution;
+        float friction;
+    };
+
+    const TileGrid& tile_grid_;
+
+    // Rebuilt every frame, kept as members so their capacity is reused. Every
+    // awake body with mass comes first, followed by anything they touch.
+    std::vector<Body> bodies_;
+    int dynamic_body_count_;
+    std::vector<int> body_by_entity_;
+    std::vector<ContactConstraint> constraints_;
+    std::vector<int> island_parents_;
+    std::vector<float> island_sleep_times_;
+    std::vector<int> island_ids_;
+
+    // Bodies of each sleeping island, so touching one wakes all of them.
+    std::unordered_map<int, std::vector<Entity>> sleeping_islands_;
+    std::vector<int> island_by_entity_;
+    int next_island_id_;
+    int sleeping_body_count_;
+
+    int GetBody(Entity entity) const {
+        const int id = entity.GetId();
+        return id < static_cast<int>(body_by_entity_.size()) ? body_by_entity_[id] : -1;
+    }
+
+    int AddBody(Entity entity) {
+        const int id = entity.GetId();
+        if (id >= static_cast<int>(body_by_entity_.size())) {
+            body_by_entity_.resize(id + 1, -1);
+        }
+
+        RigidBodyComponent* rigidBody = entity.HasComponent<RigidBodyComponent>() ? &entity.GetComponent<RigidBodyComponent>() : nullptr;
+        const bool isSimulated = rigidBody && rigidBody->IsDynamic() && !rigidBody->isSleeping;
+
+        body_by_entity_[id] = static_cast<int>(bodies_.size());
+        bodies_.push_back({
+            entity,
+            &entity.GetComponent<TransformComponent>(),
+            &entity.GetComponent<BoxColliderComponent>(),
+            rigidBody,
+            isSimulated ? 1.0f / rigidBody->mass : 0.0f,
+            rigidBody && !rigidBody->isSleeping ? rigidBody->velocity : glm::vec2(0)});
+        return body_by_entity_[id];
+    }
+
+    AABB GetBounds(const Body& body) const {
+        return CollisionSystem::GetColliderBounds(*body.transform, *body.collider);
+    }
+
+    static bool IsMoving(Entity entity) {
+        if (!entity.HasComponent<RigidBodyComponent>()) {
+            return false;
+        }
+        const auto& rigidBody = entity.GetComponent<RigidBodyComponent>();
+        return !rigidBody.isSleeping && glm::dot(rigidBody.velocity, rigidBody.velocity) > kSleepVelocity * kSleepVelocity;
+    }
+
+    static bool IsAsleep(Entity entity) {
+        return entity.HasComponent<RigidBodyComponent>() && entity.GetComponent<RigidBodyComponent>().isSleeping;
+    }
+
+    // The axis of least penetration, with the normal pointing from a to b.
+    static bool GetManifold(const AABB& a, const AABB& b, glm::vec2& normal, float& penetration) {
+        const float overlapX = std::min(a.max.x, b.max.x) - std::max(a.min.x, b.min.x);
+        const float overlapY = std::min(a.max.y, b.max.y) - std::max(a.min.y, b.min.y);
+        if (overlapX <= 0.0f || overlapY <= 0.0f) {
+            return false;
+        }
+
+        const glm::vec2 delta = (b.min + b.max) - (a.min + a.max);
+        if (overlapX < overlapY) {
+            normal = glm::vec2(delta.x < 0.0f ? -1.0f : 1.0f, 0.0f);
+            penetration = overlapX;
+        } else {
+            normal = glm::vec2(0.0f, delta.y < 0.0f ? -1.0f : 1.0f);
+            penetration = overlapY;
+        }
+        return true;
+    }
+
+    void GatherBodies(const std::vector<Contact>& contacts) {
+        bodies_.clear();
+        constraints_.clear();
+
+        // Anything moving that touches a sleeping body wakes its island first,
+        // so the island is simulated this frame.
+        for (const auto& contact : contacts) {
+            if (contact.phase == ContactPhase::CONTACT_END) {
+                continue;
+            }
+            if (IsAsleep(contact.entityA) && IsMoving(contact.entityB)) {
+                Wake(contact.entityA);
+            } else if (IsAsleep(contact.entityB) && IsMoving(contact.entityA)) {
+                Wake(contact.entityB);
+            }
+        }
+
+        sleeping_body_count_ = 0;
+        for (auto entity : GetEntities()) {
+            auto& rigidBody = entity.GetComponent<RigidBodyComponent>();
+            if (!rigidBody.IsDynamic()) {
+                continue;
+            }
+
+            if (rigidBody.isSleeping) {
+                // Gameplay code setting a velocity wakes the body up.
+                if (rigidBody.velocity == glm::vec2(0)) {
+                    sleeping_body_count_++;
+                    continue;
+                }
+                Wake(entity);
+            }
+            AddBody(entity);
+        }
+        dynamic_body_count_ = static_cast<int>(bodies_.size());
+
+        for (const auto& contact : contacts) {
+            if (contact.phase == ContactPhase::CONTACT_END) {
+                continue;
+            }
+
+            int bodyA = GetBody(contact.entityA);
+            int bodyB = GetBody(contact.entityB);
+            const bool isSimulatedA = bodyA != -1 && bodyA < dynamic_body_count_;
+            const bool isSimulatedB = bodyB != -1 && bodyB < dynamic_body_count_;
+            if (!isSimulatedA && !isSimulatedB) {
+                continue;
+            }
+
+            if (bodyA == -1) {
+                bodyA = AddBody(contact.entityA);
+            }
+            if (bodyB == -1) {
+                bodyB = AddBody(contact.entityB);
+            }
+
+            const auto* rigidBodyA = bodies_[bodyA].rigidBody;
+            const auto* rigidBodyB = bodies_[bodyB].rigidBody;
+            const float restitutionA = rigidBodyA ? rigidBodyA->restitution : 0.0f;
+            const float restitutionB = rigidBodyB ? rigidBodyB->restitution : 0.0f;
+            const float frictionA = rigidBodyA ? rigidBodyA->friction : 0.2f;
+            const float frictionB = rigidBodyB ? rigidBodyB->friction : 0.2f;
+
+            constraints_.push_back({bodyA, bodyB, std::max(restitutionA, restitutionB), std::sqrt(frictionA * frictionB)});
+        }
+    }
+
+    void SolveContact(const ContactConstraint& constraint) {
+        auto& a = bodies_[constraint.bodyA];
+        auto& b = bodies_[constraint.bodyB];
+        const float inverseMassSum = a.inverseMass + b.inverseMass;
+
+        glm::vec2 normal;
+        float penetration;
+        if (inverseMassSum == 0.0f || !GetManifold(GetBounds(a), GetBounds(b), normal, penetration)) {
+            return;
+        }
+
+        const glm::vec2 relativeVelocity = b.velocity - a.velocity;
+        const float normalSpeed = glm::dot(relativeVelocity, normal);
+
+        if (normalSpeed < 0.0f) {
+            const float normalImpulse = -(1.0f + constraint.restitution) * normalSpeed / inverseMassSum;
+            a.velocity -= normal * normalImpulse * a.inverseMass;
+            b.velocity += normal * normalImpulse * b.inverseMass;
+
+            // Coulomb friction along the contact, capped by the normal impulse.
+            const glm::vec2 tangent(-normal.y, normal.x);
+            const float tangentSpeed = glm::dot(b.velocity - a.velocity, tangent);
+            const float maxFriction = constraint.friction * normalImpulse;
+            const float tangentImpulse = glm::clamp(-tangentSpeed / inverseMassSum, -maxFriction, maxFriction);
+            a.velocity -= tangent * tangentImpulse * a.inverseMass;
+            b.velocity += tangent * tangentImpulse * b.inverseMass;
+        }
+
+        const float correction = std::max(penetration - kPenetrationSlop, 0.0f) * kPositionCorrection / inverseMassSum;
+        if (correction > 0.0f) {
+            MoveBody(a, -normal * correction * a.inverseMass);
+            MoveBody(b, normal * correction * b.inverseMass);
+        }
+    }
+
+    // Pushes never move a body into solid tiles. Returns how far it moved.
+    glm::vec2 MoveBody(Body& body, glm::vec2 delta) {
+        if (body.inverseMass == 0.0f) {
+            return glm::vec2(0);
+        }
+
+        const glm::vec2 allowed = tile_grid_.Sweep(GetBounds(body), delta, TileFlags::TILE_SOLID);
+        body.transform->position += allowed;
+        return allowed;
+    }
+
+    void Integrate(Body& body, float timeStep) {
+        body.velocity /= 1.0f + timeStep * body.rigidBody->linearDamping;
+
+        const glm::vec2 delta = body.velocity * timeStep;
+        const glm::vec2 allowed = MoveBody(body, delta);
+
+        // Bounce off solid tiles along the blocked axis.
+        if (allowed.x != delta.x) {
+            body.velocity.x *= -body.rigidBody->restitution;
+        }
+        if (allowed.y != delta.y) {
+            body.velocity.y *= -body.rigidBody->restitution;
+        }
+    }
+
+    int FindIsland(int body) {
+        while (island_parents_[body] != body) {
+            island_parents_[body] = island_parents_[island_parents_[body]];
+            body = island_parents_[body];
+        }
+        return body;
+    }
+
+    // Joins bodies with mass that touch into islands and puts the islands that
+    // have been resting long enough to sleep.
+    void UpdateSleep(float deltaTime) {
+        island_parents_.resize(dynamic_body_count_);
+        island_sleep_times_.assign(dynamic_body_count_, std::numeric_limits<float>::max());
+        island_ids_.assign(dynamic_body_count_, -1);
+
+        for (int i = 0; i < dynamic_body_count_; i++) {
+            island_parents_[i] = i;
+        }
+
+        // Bodies without mass never join islands, or everything touching the
+        // same wall would sleep and wake together.
+        for (const auto& constraint : constraints_) {
+            if (constraint.bodyA < dynamic_body_count_ && constraint.bodyB < dynamic_body_count_) {
+                island_parents_[FindIsland(constraint.bodyA)] = FindIsland(constraint.bodyB);
+            }
+        }
+
+        for (int i = 0; i < dynamic_body_count_; i++) {
+            auto& rigidBody = *bodies_[i].rigidBody;
+            const bool isResting = glm::dot(rigidBody.velocity, rigidBody.velocity) <= kSleepVelocity * kSleepVelocity;
+            rigidBody.sleepTime = isResting ? rigidBody.sleepTime + deltaTime : 0.0f;
+
+            float& islandSleepTime = island_sleep_times_[FindIsland(i)];
+            islandSleepTime = std::min(islandSleepTime, rigidBody.sleepTime);
+        }
+
+        for (int i = 0; i < dynamic_body_count_; i++) {
+            const int island = FindIsland(i);
+            if (island_sleep_times_[island] < kTimeToSleep) {
+                continue;
+            }
+
+            if (island_ids_[island] == -1) {
+                island_ids_[island] = next_island_id_++;
+            }
+            const int islandId = island_ids_[island];
+            auto& rigidBody = *bodies_[i].rigidBody;
+            rigidBody.velocity = glm::vec2(0);
+            rigidBody.isSleeping = true;
+
+            const int id = bodies_[i].entity.GetId();
+            if (id >= static_cast<int>(island_by_entity_.size())) {
+                island_by_entity_.resize(id + 1, -1);
+            }
+            island_by_entity_[id] = islandId;
+            sleeping_islands_[islandId].push_back(bodies_[i].entity);
+            sleeping_body_count_++;
+        }
+    }
+
+   public:
+    PhysicsSystem(const TileGrid& tileGrid)
+        : tile_grid_(tileGrid),
+          bodies_(),
+          dynamic_body_count_(0),
+          body_by_entity_(),
+          constraints_(),
+          island_parents_(),
+          island_sleep_times_(),
+          island_ids_(),
+          sleeping_islands_(),
+          island_by_entity_(),
+          next_island_id_(0),
+          sleeping_body_count_(0) {
+        RequireComponent<TransformComponent>();
+        RequireComponent<RigidBodyComponent>();
+        RequireComponent<BoxColliderComponent>();
+    }
+
+    ~PhysicsSystem() = default;
+
+    // Runs after the collision system, using its contacts as the pair list.
+    void Update(double deltaTime, const std::vector<Contact>& contacts) {
+        {
+            PROFILE_SCOPE("Gather bodies");
+            GatherBodies(contacts);
+        }
+
+        PROFILE_SCOPE("Solver");
+        const float timeStep = static_cast<float>(deltaTime) / kPhysicsSubsteps;
+        for (int substep = 0; substep < kPhysicsSubsteps; substep++) {
+            for (int i = 0; i < dynamic_body_count_; i++) {
+                Integrate(bodies_[i], timeStep);
+            }
+            for (const auto& constraint : constraints_) {
+                SolveContact(constraint);
+            }
+        }
+
+        for (int i = 0; i < dynamic_body_count_; i++) {
+            bodies_[i].rigidBody->velocity = bodies_[i].velocity;
+        }
+
+        UpdateSleep(static_cast<float>(deltaTime));
+
+        for (const auto& body : bodies_) {
+            body_by_entity_[body.entity.GetId()] = -1;
+        }
+    }
+
+    // A body removed while asleep leaves its island, and an island left empty
+    // is dropped, so an entity that reuses the id starts awake and alone.
+    void OnEntityRemoved(Entity entity) override {
+        const int id = entity.GetId();
+        if (id >= static_cast<int>(island_by_entity_.size()) || island_by_entity_[id] == -1) {
+            return;
+        }
+
+        const auto island = sleeping_islands_.find(island_by_entity_[id]);
+        island_by_entity_[id] = -1;
+
+        if (island != sleeping_islands_.end()) {
+            auto& members = island->second;
+            members.erase(std::remove(members.begin(), members.end(), entity), members.end());
+            if (members.empty()) {
+                sleeping_islands_.erase(island);
+            }
+        }
+    }
+
+    // Wakes the entity and every body in its sleeping island.
+    void Wake(Entity entity) {
+        const int id = entity.GetId();
+        const int islandId = id < static_cast<int>(island_by_entity_.size()) ? island_by_entity_[id] : -1;
+        const auto island = sleeping_islands_.find(islandId);
+
+        if (island == sleeping_islands_.end()) {
+            if (entity.HasComponent<RigidBodyComponent>()) {
+                entity.GetComponent<RigidBodyComponent>().isSleeping = false;
+            }
+            return;
+        }
+
+        for (auto member : island->second) {
+            island_by_entity_[member.GetId()] = -1;
+
+            if (member.HasComponent<RigidBodyComponent>()) {
+                auto& rigidBody = member.GetComponent<RigidBodyComponent>();
+                rigidBody.isSleeping = false;
+                rigidBody.sleepTime = 0.0f;
+            }
+        }
+        sleeping_islands_.erase(island);
+    }
+
+    int GetAwakeBodyCount() const {
+        return dynamic_body_count_;
+    }
+
+    int GetSleepingBodyCount() const {
+        return sleeping_body_count_;
+    }
+
+    int GetContactConstraintCount() const {
+        return static_cast<int>(constraints_.size());
+    }
+};
@@ -4,30 +4,57 @@
 #include <SDL2/SDL_keycode.h>
 
 #include <glm/glm.hpp>
+#include <unordered_map>
 
-#include "../Components/BoxColliderComponent.h"
-#include "../Components/ProjectileComponent.h"
+#include "../Bullets/BulletManager.h"
 #include "../Components/ProjectileEmitterComponent.h"
 #include "../Components/RigidBodyComponent.h"
 #include "../Components/SpriteComponent.h"
 #include "../Components/TransformComponent.h"
 #include "../ECS/ECS.h"
 #include "../General/Logger.h"
+#include "../General/TimerWheel.h"
 
+/**
+ * Fires the projectile emitters. Enemy emitters repeat on a timer, so a frame
+ * only visits the emitters whose timer fired. Friendly emitters fire when the
+ * player presses space.
+ */
 class ProjectileEmitSystem : public System {
    public:
-    ProjectileEmitSystem() : spawnFriendlyProjectiles_(false) {
+    ProjectileEmitSystem(BulletManager& bullets, TimerWheel& timers)
+        : spawnFriendlyProjectiles_(false),
+          bullets_(bullets),
+          timers_(timers),
+          timer_channel_(timers.CreateChannel()),
+          emitters_(),
+          key_input_subscription_() {
         RequireComponent<TransformComponent>();
         RequireComponent<ProjectileEmitterComponent>();
     }
 
     ~ProjectileEmitSystem() = default;
 
+    void OnEntityAdded(Entity entity) override {
+        auto& emitter = entity.GetComponent<ProjectileEmitterComponent>();
+
+        if (!emitter.isFriendly) {
+            const double period = emitter.frequency / 1000.0;
+            emitter.emissionTimer = timers_.Schedule(timer_channel_, period, period, entity.GetId());
+            emitters_.emplace(entity.GetId(), entity);
+        }
+    }
+
+    void OnEntityRemoved(Entity entity) override {
+        timers_.Cancel(entity.GetComponent<ProjectileEmitterComponent>().emissionTimer);
+        emitters_.erase(entity.GetId());
+    }
+
     void SubscribeToEvents(std::unique_ptr<EventBus>& eventBus) {
-        eventBus->SubscribeEvent<ProjectileEmitSystem, KeyInputEvent>(this, &ProjectileEmitSystem::OnKeyInput);
+        key_input_subscription_ = eventBus->SubscribeEvent<ProjectileEmitSystem, KeyInputEvent>(this, &ProjectileEmitSystem::OnKeyInput);
     }
 
-    void OnKeyInput(KeyInputEvent& event) {
+    void OnKeyInput(const KeyInputEvent& event) {
         if (!event.isPressed) {
             return;
         }
@@ -39,24 +66,42 @@ class ProjectileEmitSystem : public System {
         }
     }
 
-    void Update(std::unique_ptr<Registry>& registry) {
+    void Update() {
+        for (const auto& fired : timers_.GetFired(timer_channel_)) {
+            auto it = emitters_.find(fired.data);
+
+            if (it != emitters_.end()) {
+                auto entity = it->second;
+                SpawnProjectile(entity.GetComponent<TransformComponent>(), entity, entity.GetComponent<ProjectileEmitterComponent>());
+            }
+        }
+
+        if (!spawnFriendlyProjectiles_) {
+            return;
+        }
+
         for (auto entity : GetEntities()) {
-            auto transform = entity.GetComponent<TransformComponent>();
             auto& emitter = entity.GetComponent<ProjectileEmitterComponent>();
 
-            if (!emitter.isFriendly && static_cast<int>(SDL_GetTicks()) - emitter.lastEmissionTime > emitter.frequency) {
-                SpawnProjectile(transform, entity, registry, emitter);
-            } else if (emitter.isFriendly && spawnFriendlyProjectiles_) {
-                SpawnProjectile(transform, entity, registry, emitter);
-                spawnFriendlyProjectiles_ = false;
+            if (emitter.isFriendly) {
+                SpawnProjectile(entity.GetComponent<TransformComponent>(), entity, emitter);
+                break;
             }
         }
+
+        spawnFriendlyProjectiles_ = false;
     }
 
    private:
     bool spawnFriendlyProjectiles_;
-
-    void SpawnProjectile(TransformComponent& transform, Entity& entity, std::unique_ptr<Registry>& registry, ProjectileEmitterComponent& emitter) {
+    BulletManager& bullets_;
+    TimerWheel& timers_;
+    int timer_channel_;
+    // The enemy emitters by entity id, which their timers carry.
+    std::unordered_map<int, Entity> emitters_;
+    EventSubscription key_input_subscription_;
+
+    void SpawnProjectile(const TransformComponent& transform, Entity& entity, const ProjectileEmitterComponent& emitter) {
         auto projectilePosition = transform.position;
         auto velocity = emitter.velocity;
 
@@ -72,14 +117,7 @@ class ProjectileEmitSystem : public System {
             velocity = direction * emitter.velocity;
         }
 
-        auto projectile = registry->CreateEntity();
-        projectile.Group("projectiles");
-        projectile.AddComponent<TransformComponent>(projectilePosition, glm::vec2(1.0, 1.0), 0.0);
-        projectile.AddComponent<RigidBodyComponent>(velocity);
-        projectile.AddComponent<BoxColliderComponent>(4, 4);
-        projectile.AddComponent<SpriteComponent>("bullet-texture", 4, 4, 4);
-        projectile.AddComponent<ProjectileComponent>(emitter.damage, SDL_GetTicks(), emitter.duration, emitter.isFriendly);
-
-        emitter.lastEmissionTime = SDL_GetTicks();
+        const auto faction = emitter.isFriendly ? BulletFaction::FACTION_PLAYER : BulletFaction::FACTION_ENEMIES;
+        bullets_.Spawn(projectilePosition, velocity, emitter.duration / 1000.0f, emitter.damage, faction);
     }
 };
\ No newline at end of file
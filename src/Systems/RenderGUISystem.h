@@ -3,6 +3,8 @@
 #include <SDL2/SDL.h>
 #include <imgui/imgui.h>
 
+#include <algorithm>
+
 #include "../Components/BoxColliderComponent.h"
 #include "../Components/HealthComponent.h"
 #include "../Components/ProjectileEmitterComponent.h"
@@ -10,6 +12,17 @@
 #include "../Components/SpriteComponent.h"
 #include "../Components/TransformComponent.h"
 #include "../ECS/ECS.h"
+#include "../Game/FrameScheduler.h"
+#include "../General/FramePacer.h"
+#include "../General/MemoryTracker.h"
+#include "../General/PerfCounters.h"
+#include "../General/Profiler.h"
+#include "./BulletSystem.h"
+#include "./CollisionSystem.h"
+#include "./PhysicsSystem.h"
+
+// Frames after ticking "Expect no allocations" before allocations count.
+const int kAllocationWarmUpFrames = 60;
 
 class RenderGUISystem : public System {
    public:
@@ -18,18 +31,299 @@ class RenderGUISystem : public System {
 
     ~RenderGUISystem() = default;
 
-    void Update(SDL_Renderer* renderer, std::unique_ptr<Registry>& registry) {
+    void Update(SDL_Renderer* renderer, std::unique_ptr<Registry>& registry, FramePacer& framePacer, const FrameScheduler& frameScheduler, const std::vector<MemoryUsage>& memoryUsage) {
         ImGui_ImplSDLRenderer2_NewFrame();
         ImGui_ImplSDL2_NewFrame();
         ImGui::NewFrame();
         ImGui::ShowDemoWindow();
         SpawnEnemyWindow(registry);
+        CollisionWindow(registry);
+        FramePacingWindow(framePacer, frameScheduler);
+        ProfilerWindow();
+        MemoryWindow(memoryUsage);
 
         ImGui::Render();
         ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData(), renderer);
     }
 
    private:
+    void FramePacingWindow(FramePacer& framePacer, const FrameScheduler& frameScheduler) {
+        if (ImGui::Begin("Frame pacing")) {
+            const char* modes[] = {
+                FramePacer::GetModeName(FramePacingMode::PACING_SLEEP_SPIN),
+                FramePacer::GetModeName(FramePacingMode::PACING_VSYNC),
+                FramePacer::GetModeName(FramePacingMode::PACING_ADAPTIVE),
+                FramePacer::GetModeName(FramePacingMode::PACING_UNCAPPED)};
+            int modeIndex = static_cast<int>(framePacer.GetMode());
+
+            if (ImGui::Combo("Mode", &modeIndex, modes, IM_ARRAYSIZE(modes))) {
+                framePacer.SetMode(static_cast<FramePacingMode>(modeIndex));
+            }
+            ImGui::Text("Vsync: %s", framePacer.IsVSyncOn() ? "on" : "off");
+
+            const auto stats = framePacer.GetStats();
+            ImGui::Text("Average: %.3f ms", stats.average * 1000.0);
+            ImGui::Text("Deviation: %.3f ms", stats.deviation * 1000.0);
+            ImGui::Text("p50: %.3f ms", stats.p50 * 1000.0);
+            ImGui::Text("p99: %.3f ms", stats.p99 * 1000.0);
+            ImGui::Text("Max: %.3f ms", stats.max * 1000.0);
+
+            ImGui::SeparatorText("Deferred systems");
+            for (const auto& deferred : frameScheduler.GetStats()) {
+                ImGui::Text("%s: %d/%d parts, %d frames stale, %.3f ms a part",
+                            deferred.name.c_str(), deferred.partsRun, deferred.partCount, deferred.staleFrames, deferred.partSeconds * 1000.0);
+            }
+        }
+        ImGui::End();
+    }
+
+    void ProfilerWindow() {
+        if (ImGui::Begin("Profiler")) {
+            bool isEnabled = Profiler::IsEnabled();
+            if (ImGui::Checkbox("Enabled", &isEnabled)) {
+                Profiler::SetEnabled(isEnabled);
+            }
+
+            ProfileFrame frame;
+            if (Profiler::GetFrame(0, frame)) {
+                ImGui::Text("Last frame: %.3f ms", Profiler::ToMilliseconds(frame.end - frame.start));
+                ProfilerTimeline(frame);
+            }
+
+            if (ImGui::Button("Export trace")) {
+                Profiler::ExportChromeTrace("profile-trace.json");
+            }
+
+            bool isExportOnSpike = Profiler::IsExportOnSpike();
+            float spikeMilliseconds = static_cast<float>(Profiler::GetSpikeSeconds() * 1000.0);
+            bool isChanged = ImGui::Checkbox("Export on spike", &isExportOnSpike);
+            isChanged |= ImGui::SliderFloat("Spike threshold (ms)", &spikeMilliseconds, 1.0f, 100.0f, "%.1f");
+            if (isChanged) {
+                Profiler::SetExportOnSpike(isExportOnSpike, spikeMilliseconds / 1000.0);
+            }
+
+            ProfilerCounters();
+
+            ImGui::SeparatorText("Scopes");
+            if (ImGui::BeginTable("Scopes", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+                ImGui::TableSetupColumn("Scope");
+                ImGui::TableSetupColumn("p50 ms");
+                ImGui::TableSetupColumn("p95 ms");
+                ImGui::TableSetupColumn("p99 ms");
+                ImGui::TableSetupColumn("Frames");
+                ImGui::TableHeadersRow();
+
+                for (const auto& scope : Profiler::GetScopeStats()) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(scope.name.c_str());
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", scope.p50);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", scope.p95);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", scope.p99);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%d", scope.frames);
+                }
+                ImGui::EndTable();
+            }
+        }
+        ImGui::End();
+    }
+
+    void ProfilerCounters() {
+        ImGui::SeparatorText("Hardware counters");
+        bool isCounting = PerfCounters::IsOpen();
+        if (ImGui::Checkbox("Count", &isCounting)) {
+            if (isCounting) {
+                PerfCounters::Open();
+            } else {
+                PerfCounters::Close();
+            }
+        }
+
+        if (!PerfCounters::IsOpen()) {
+            return;
+        }
+
+        ImGui::SameLine();
+        if (ImGui::Button("Reset counters")) {
+            PerfCounters::Reset();
+        }
+
+        if (ImGui::BeginTable("Counters", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+            ImGui::TableSetupColumn("Scope");
+            ImGui::TableSetupColumn("Cycles/call");
+            ImGui::TableSetupColumn("IPC");
+            ImGui::TableSetupColumn("Cache misses/entity");
+            ImGui::TableSetupColumn("Branch misses/entity");
+            ImGui::TableHeadersRow();
+
+            for (const auto& scope : PerfCounters::GetStats()) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(scope.name.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%.0f", scope.cyclesPerCall);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", scope.instructionsPerCycle);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", scope.cacheMissesPerItem);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", scope.branchMissesPerItem);
+            }
+            ImGui::EndTable();
+        }
+    }
+
+    void MemoryWindow(const std::vector<MemoryUsage>& memoryUsage) {
+        if (ImGui::Begin("Memory")) {
+            size_t totalBytes = 0;
+            for (const auto& entry : memoryUsage) {
+                totalBytes += entry.reservedBytes + entry.overheadBytes;
+            }
+            ImGui::Text("Total: %.1f KB", totalBytes / 1024.0);
+            ImGui::Text("Lua heap: %.1f KB, peak %.1f KB", MemoryTracker::GetLuaBytes() / 1024.0, MemoryTracker::GetLuaPeakBytes() / 1024.0);
+
+            if (ImGui::Button("Write report")) {
+                MemoryTracker::WriteReport("memory-report.txt", memoryUsage);
+            }
+
+            if (ImGui::BeginTable("Usage", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+                ImGui::TableSetupColumn("Name");
+                ImGui::TableSetupColumn("Count");
+                ImGui::TableSetupColumn("Used KB");
+                ImGui::TableSetupColumn("Reserved KB");
+                ImGui::TableSetupColumn("Overhead KB");
+                ImGui::TableHeadersRow();
+
+                for (const auto& entry : memoryUsage) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(entry.name.c_str());
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%d", entry.count);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.1f", entry.usedBytes / 1024.0);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.1f", entry.reservedBytes / 1024.0);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.1f", entry.overheadBytes / 1024.0);
+                }
+                ImGui::EndTable();
+            }
+
+            ImGui::SeparatorText("Allocations last frame");
+            if (!MemoryTracker::IsAllocationHookInstalled()) {
+                ImGui::TextUnformatted("Build with TRACK_ALLOCATIONS=1 to count allocations.");
+            } else {
+                ImGui::Text("Total: %llu, other threads: %llu",
+                            static_cast<unsigned long long>(MemoryTracker::GetFrameAllocationCount()),
+                            static_cast<unsigned long long>(MemoryTracker::GetOtherThreadAllocationCount()));
+                for (const auto& count : MemoryTracker::GetFrameAllocations()) {
+                    ImGui::Text("%s: %llu, %.1f KB", count.scope, static_cast<unsigned long long>(count.count), count.bytes / 1024.0);
+                }
+
+                // The overlay itself allocates, so sites from it are expected.
+                bool isExpectingNoAllocations = MemoryTracker::IsExpectingNoAllocations();
+                if (ImGui::Checkbox("Expect no allocations", &isExpectingNoAllocations)) {
+                    if (isExpectingNoAllocations) {
+                        MemoryTracker::ExpectNoAllocations(kAllocationWarmUpFrames);
+                    } else {
+                        MemoryTracker::StopExpectingNoAllocations();
+                    }
+                }
+                ImGui::Text("Unexpected: %llu at %d sites, stacks are logged",
+                            static_cast<unsigned long long>(MemoryTracker::GetUnexpectedAllocationCount()), MemoryTracker::GetAllocationSiteCount());
+                for (int i = 0; i < MemoryTracker::GetAllocationSiteCount(); i++) {
+                    const auto& site = MemoryTracker::GetAllocationSite(i);
+                    ImGui::Text("%s: %llu, %.1f KB", site.scope, static_cast<unsigned long long>(site.count), site.bytes / 1024.0);
+                }
+            }
+        }
+        ImGui::End();
+    }
+
+    // Draws the frame's scopes as bars, one row per nesting depth.
+    void ProfilerTimeline(const ProfileFrame& frame) {
+        const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+        const float width = ImGui::GetContentRegionAvail().x;
+        const double frameMilliseconds = std::max(Profiler::ToMilliseconds(frame.end - frame.start), 0.001);
+        int rows = 1;
+
+        for (uint64_t i = frame.firstEvent; i < frame.lastEvent; i++) {
+            rows = std::max(rows, Profiler::GetEvent(i).depth + 1);
+        }
+
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        ImGui::InvisibleButton("Timeline", ImVec2(width, rowHeight * rows));
+        const bool isHovered = ImGui::IsItemHovered();
+        const ImVec2 mouse = ImGui::GetIO().MousePos;
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+
+        for (uint64_t i = frame.firstEvent; i < frame.lastEvent; i++) {
+            const auto& event = Profiler::GetEvent(i);
+            const double start = Profiler::ToMilliseconds(event.start - frame.start);
+            const double duration = Profiler::ToMilliseconds(event.end - event.start);
+            const ImVec2 min(origin.x + static_cast<float>(start / frameMilliseconds) * width, origin.y + event.depth * rowHeight);
+            const ImVec2 max(std::max(min.x + 1.0f, origin.x + static_cast<float>((start + duration) / frameMilliseconds) * width), min.y + rowHeight - 1.0f);
+            const ImU32 color = ImColor::HSV((event.depth * 0.13f) - static_cast<int>(event.depth * 0.13f), 0.6f, 0.7f);
+
+            drawList->AddRectFilled(min, max, color);
+            if (max.x - min.x > ImGui::CalcTextSize(event.name).x) {
+                drawList->AddText(ImVec2(min.x + 2.0f, min.y), IM_COL32_WHITE, event.name);
+            }
+
+            if (isHovered && mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y && mouse.y < max.y) {
+                ImGui::SetTooltip("%s\n%.3f ms", event.name, duration);
+            }
+        }
+    }
+
+    void CollisionWindow(std::unique_ptr<Registry>& registry) {
+        if (ImGui::Begin("Collision")) {
+            auto& collisionSystem = registry->GetSystem<CollisionSystem>();
+            const char* broadPhases[] = {"Brute force", "Spatial hash", "Sweep and prune", "AABB tree"};
+            int broadPhaseIndex = static_cast<int>(collisionSystem.GetBroadPhaseType());
+
+            if (ImGui::Combo("Broad phase", &broadPhaseIndex, broadPhases, IM_ARRAYSIZE(broadPhases))) {
+                collisionSystem.SetBroadPhase(static_cast<BroadPhaseType>(broadPhaseIndex));
+            }
+
+            const char* kernels[] = {
+                ColliderSoA::GetKernelName(OverlapKernel::SCALAR),
+                ColliderSoA::GetKernelName(OverlapKernel::SSE2),
+                ColliderSoA::GetKernelName(OverlapKernel::AVX2)};
+            int kernelIndex = static_cast<int>(ColliderSoA::GetKernel());
+
+            if (ImGui::Combo("Overlap kernel", &kernelIndex, kernels, IM_ARRAYSIZE(kernels))) {
+                ColliderSoA::SetKernel(static_cast<OverlapKernel>(kernelIndex));
+            }
+            ImGui::Text("Overlapping pairs: %d", static_cast<int>(collisionSystem.GetOverlappingPairs().size()));
+            ImGui::Text("Contacts: %d", static_cast<int>(collisionSystem.GetContacts().size()));
+
+            const auto& physicsSystem = registry->GetSystem<PhysicsSystem>();
+            ImGui::SeparatorText("Physics");
+            ImGui::Text("Awake bodies: %d", physicsSystem.GetAwakeBodyCount());
+            ImGui::Text("Sleeping bodies: %d", physicsSystem.GetSleepingBodyCount());
+            ImGui::Text("Contact constraints: %d", physicsSystem.GetContactConstraintCount());
+
+            // The solver is timed by its profile scope, so the time is from
+            // the last frame the profiler recorded.
+            double solverMilliseconds;
+            if (Profiler::IsEnabled() && Profiler::GetScopeMilliseconds(0, "Solver", solverMilliseconds)) {
+                ImGui::Text("Solver: %.3f ms", solverMilliseconds);
+            } else {
+                ImGui::Text("Solver: profiler off");
+            }
+
+            ImGui::SeparatorText("Bullets");
+            ImGui::Text("Live bullets: %d", registry->GetSystem<BulletSystem>().GetBullets().GetCount());
+        }
+        ImGui::End();
+    }
+
     void SpawnEnemyWindow(std::unique_ptr<Registry>& registry) {
         if (ImGui::Begin("Spawn enemy")) {
             static int xPos = 0, yPos = 0;
@@ -91,7 +385,7 @@ class RenderGUISystem : public System {
                 enemy.AddComponent<TransformComponent>(glm::vec2(xPos, yPos), glm::vec2(scale, scale), rotation);
                 enemy.AddComponent<RigidBodyComponent>(glm::vec2(xVelocity, yVelocity));
                 enemy.AddComponent<SpriteComponent>(sprite, 32, 32, 1);
-                enemy.AddComponent<BoxColliderComponent>(32, 32);
+                enemy.AddComponent<BoxColliderComponent>(32, 32, glm::vec2(0), LAYER_ENEMIES, LAYER_PLAYER | LAYER_OBSTACLES);
                 enemy.AddComponent<ProjectileEmitterComponent>(projectileVelocity, projectileDurationMs, projectileFrequencyMs, projectileDamage, false);
                 enemy.AddComponent<HealthComponent>(maxHealth, startingHealth);
             }
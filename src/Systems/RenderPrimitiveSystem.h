@@ -14,7 +14,7 @@ class RenderPrimitiveSystem : public System {
     ~RenderPrimitiveSystem() = default;
 
     void Update(RenderQueue& renderQueue) {
-        auto entities = GetEntities();
+        const auto& entities = GetEntities();
 
         for (auto entity : entities) {
             if (entity.HasComponent<SquarePrimitiveComponent>()) {
@@ -18,31 +18,30 @@ class RenderSpriteSystem : public System {
 
     ~RenderSpriteSystem() = default;
 
-    void Update(RenderQueue& renderQueue, SDL_Rect& camera) {
-        auto entities = GetEntities();
-
+    void Update(RenderQueue& renderQueue, SDL_Rect& camera, float alpha) {
         for (auto entity : GetEntities()) {
             auto transform = entity.GetComponent<TransformComponent>();
             auto sprite = entity.GetComponent<SpriteComponent>();
+            const auto position = transform.GetInterpolatedPosition(alpha);
 
             bool isOutsideCamera = false;
 
             if (sprite.isFixed) {
-                isOutsideCamera = (transform.position.x + sprite.width * transform.scale.x < 0 ||
-                                   transform.position.x > Game::windowWidth ||
-                                   transform.position.y + sprite.height * transform.scale.y < 0 ||
-                                   transform.position.y > Game::windowHeight);
+                isOutsideCamera = (position.x + sprite.width * transform.scale.x < 0 ||
+                                   position.x > Game::windowWidth ||
+                                   position.y + sprite.height * transform.scale.y < 0 ||
+                                   position.y > Game::windowHeight);
             } else {
-                isOutsideCamera = (transform.position.x + sprite.width * transform.scale.x < camera.x ||
-                                   transform.position.x > camera.x + camera.w ||
-                                   transform.position.y + sprite.height * transform.scale.y < camera.y ||
-                                   transform.position.y > camera.y + camera.h);
+                isOutsideCamera = (position.x + sprite.width * transform.scale.x < camera.x ||
+                                   position.x > camera.x + camera.w ||
+                                   position.y + sprite.height * transform.scale.y < camera.y ||
+                                   position.y > camera.y + camera.h);
             }
 
             if (!isOutsideCamera) {
                 RenderKey renderKey(
                     sprite.layer,
-                    transform.position.y,
+                    position.y,
                     RenderableType::SPRITE,
                     entity);
 
@@ -15,7 +15,7 @@ class RenderTextSystem : public System {
     ~RenderTextSystem() = default;
 
     void Update(RenderQueue& renderQueue) {
-        auto entities = GetEntities();
+        const auto& entities = GetEntities();
 
         for (auto entity : entities) {
             auto text = entity.GetComponent<TextLabelComponent>();
@@ -8,13 +8,18 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include "../Components/BoxColliderComponent.h"
 #include "../Components/ScriptComponent.h"
 #include "../Components/SpriteComponent.h"
 #include "../Components/TransformComponent.h"
 #include "../ECS/ECS.h"
+#include "../EventBus/EventBus.h"
+#include "../Events/CollisionEvent.h"
+#include "../Events/KeyInputEvent.h"
 #include "../General/Logger.h"
+#include "../General/Profiler.h"
 
-int GetEntityPosition(Entity entity) {
+inline int GetEntityPosition(Entity entity) {
     if (!entity.HasComponent<TransformComponent>()) {
         Logger::Error("Entity does not have TransformComponent.");
         return 0;
@@ -24,7 +29,7 @@ int GetEntityPosition(Entity entity) {
     return transform.position.x;
 }
 
-void SetEntityPosition(Entity entity, double x, double y) {
+inline void SetEntityPosition(Entity entity, double x, double y) {
     if (!entity.HasComponent<TransformComponent>()) {
         Logger::Error("Entity does not have TransformComponent.");
         return;
@@ -35,7 +40,7 @@ void SetEntityPosition(Entity entity, double x, double y) {
     transform.position.y = y;
 }
 
-void SetEntitySpriteSrcRect(Entity entity, int srcRectX, int srcRectY) {
+inline void SetEntitySpriteSrcRect(Entity entity, int srcRectX, int srcRectY) {
     if (!entity.HasComponent<SpriteComponent>()) {
         Logger::Error("Entity does not have SpriteComponent.");
         return;
@@ -48,7 +53,7 @@ void SetEntitySpriteSrcRect(Entity entity, int srcRectX, int srcRectY) {
 
 class ScriptSystem : public System {
    public:
-    ScriptSystem() : pressedKeys_(), heldKeys_(), keyMap_() {
+    ScriptSystem() : pressedKeys_(), heldKeys_(), keyMap_(), key_buffer_(), lua_state_(nullptr), key_input_subscription_(), collision_subscription_() {
         RequireComponent<ScriptComponent>();
         keyMap_["ctrl"] = {"left ctrl", "right ctrl"};
         keyMap_["shift"] = {"left shift", "right shift"};
@@ -58,6 +63,7 @@ class ScriptSystem : public System {
     ~ScriptSystem() = default;
 
     void CreateLuaBindings(sol::state& lua) {
+        lua_state_ = lua.lua_state();
         lua.new_usertype<Entity>(
             "entity",
             "get_id", &Entity::GetId,
@@ -70,21 +76,40 @@ class ScriptSystem : public System {
         lua.set_function("is_key_pressed", &ScriptSystem::IsKeyPressed, this);
         lua.set_function("is_key_held", &ScriptSystem::IsKeyHeld, this);
         lua.set_function("quit_game", &Game::Quit);
+        lua["collision_layer"] = lua.create_table_with(
+            "default", LAYER_DEFAULT,
+            "player", LAYER_PLAYER,
+            "enemies", LAYER_ENEMIES,
+            "player_projectiles", LAYER_PLAYER_PROJECTILES,
+            "enemy_projectiles", LAYER_ENEMY_PROJECTILES,
+            "obstacles", LAYER_OBSTACLES,
+            "ui", LAYER_UI,
+            "all", kCollideWithAll);
     }
 
-    void Update(double deltaTime, int elapsedTime) {
+    void OnEntityAdded(Entity entity) override {
+        if (lua_state_) {
+            entity.GetComponent<ScriptComponent>().luaEntity = sol::make_object(lua_state_, entity);
+        }
+    }
+
+    // Scripts get the game time in milliseconds.
+    void Update(double deltaTime, double elapsedTime) {
+        PROFILE_SCOPE("Lua update");
         for (auto entity : GetEntities()) {
             auto& script = entity.GetComponent<ScriptComponent>();
-            script.updateFunction(entity, deltaTime, elapsedTime);
+            if (script.updateFunction.valid()) {
+                script.updateFunction(script.luaEntity, deltaTime, elapsedTime);
+            }
         }
         pressedKeys_.clear();
     }
 
-    bool IsKeyPressed(const std::string& key) {
-        if (key.empty()) {
+    bool IsKeyPressed(const char* key) {
+        if (!key || !*key) {
             return false;
         }
-        std::string lowerKey = makeKey(key);
+        const std::string& lowerKey = makeKey(key);
 
         auto it = keyMap_.find(lowerKey);
 
@@ -98,11 +123,11 @@ class ScriptSystem : public System {
         return pressedKeys_.find(lowerKey) != pressedKeys_.end();
     }
 
-    bool IsKeyHeld(const std::string& key) {
-        if (key.empty()) {
+    bool IsKeyHeld(const char* key) {
+        if (!key || !*key) {
             return false;
         }
-        std::string lowerKey = makeKey(key);
+        const std::string& lowerKey = makeKey(key);
 
         auto it = keyMap_.find(lowerKey);
 
@@ -117,10 +142,35 @@ class ScriptSystem : public System {
     }
 
     void SubscribeToEvents(std::unique_ptr<EventBus>& eventBus) {
-        eventBus->SubscribeEvent<ScriptSystem, KeyInputEvent>(this, &ScriptSystem::OnKeyInput);
+        key_input_subscription_ = eventBus->SubscribeEvent<ScriptSystem, KeyInputEvent>(this, &ScriptSystem::OnKeyInput);
+        // Only collisions involving a scripted entity are routed here.
+        collision_subscription_ = eventBus->SubscribeComponentEvent<ScriptComponent>(this, &ScriptSystem::OnCollision);
+    }
+
+    void OnCollision(const CollisionEvent& event) {
+        PROFILE_SCOPE("Lua collision");
+        for (int i = 0; i < event.GetEntityCount(); i++) {
+            auto entity = event.GetEntity(i);
+            auto other = event.GetEntity(1 - i);
+
+            if (!entity.HasComponent<ScriptComponent>()) {
+                continue;
+            }
+
+            auto& script = entity.GetComponent<ScriptComponent>();
+            if (!script.collisionFunction.valid()) {
+                continue;
+            }
+
+            if (other.HasComponent<ScriptComponent>()) {
+                script.collisionFunction(script.luaEntity, other.GetComponent<ScriptComponent>().luaEntity);
+            } else {
+                script.collisionFunction(script.luaEntity, other);
+            }
+        }
     }
 
-    void OnKeyInput(KeyInputEvent& event) {
+    void OnKeyInput(const KeyInputEvent& event) {
         std::string key = makeKey(SDL_GetKeyName(event.inputKey));
         if (event.isPressed) {
             if (heldKeys_.find(key) == heldKeys_.end()) {
@@ -133,14 +183,20 @@ class ScriptSystem : public System {
         }
     }
 
-    std::string makeKey(const std::string& key) {
-        std::string lowerKey = key;
-        std::transform(lowerKey.begin(), lowerKey.end(), lowerKey.begin(), ::tolower);
-        return lowerKey;
+    // Lowercases the key into a buffer that is reused between calls, so
+    // polling keys every update does not allocate.
+    const std::string& makeKey(const char* key) {
+        key_buffer_.assign(key);
+        std::transform(key_buffer_.begin(), key_buffer_.end(), key_buffer_.begin(), ::tolower);
+        return key_buffer_;
     }
 
    private:
     std::unordered_set<std::string> pressedKeys_;
     std::unordered_set<std::string> heldKeys_;
     std::unordered_map<std::string, std::unordered_set<std::string>> keyMap_;
+    std::string key_buffer_;
+    lua_State* lua_state_;
+    EventSubscription key_input_subscription_;
+    EventSubscription collision_subscription_;
 };
\ No newline at end of file
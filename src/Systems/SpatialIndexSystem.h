@@ -0,0 +1,244 @@
+#pragma once
+
+#include <sol/sol.hpp>
+#include <tuple>
+#include <vector>
+
+#include "../Components/BoxColliderComponent.h"
+#include "../Components/SpriteComponent.h"
+#include "../Components/TransformComponent.h"
+#include "../ECS/ECS.h"
+#include "../Physics/AABB.h"
+#include "../Physics/DynamicAABBTree.h"
+#include "./CollisionSystem.h"
+
+enum SpatialSpace {
+    WORLD_SPACE,
+    SCREEN_SPACE
+};
+
+/**
+ * Indexes every collider by its bounds so gameplay code, scripts and UI can ask
+ * what is at or near a point without scanning every entity. Colliders on fixed
+ * sprites are drawn in screen space and get their own index. The indexes are
+ * refreshed once per frame, after movement.
+ */
+class SpatialIndexSystem : public System {
+   private:
+    struct IndexedEntity {
+        Entity entity;
+        AABB bounds;
+        SpatialSpace space;
+        // kNullNode while the entity is not indexed.
+        int proxy;
+        uint32_t lastSeenFrame;
+    };
+
+    DynamicAABBTree trees_[2];
+    // Indexed by entity id.
+    std::vector<IndexedEntity> indexed_;
+    // The ids that currently have a proxy, so removed entities can be found.
+    std::vector<int> indexed_ids_;
+    uint32_t frame_;
+
+    // Reused by the Lua queries so a query only writes ids into the table.
+    std::vector<Entity> lua_results_;
+
+    static SpatialSpace GetSpace(Entity entity) {
+        if (entity.HasComponent<SpriteComponent>() && entity.GetComponent<SpriteComponent>().isFixed) {
+            return SpatialSpace::SCREEN_SPACE;
+        }
+        return SpatialSpace::WORLD_SPACE;
+    }
+
+    const IndexedEntity& GetIndexed(SpatialSpace space, int proxy) const {
+        return indexed_[trees_[space].GetUserData(proxy)];
+    }
+
+    void RemoveUnseen() {
+        for (int i = 0; i < static_cast<int>(indexed_ids_.size());) {
+            auto& indexed = indexed_[indexed_ids_[i]];
+
+            if (indexed.lastSeenFrame == frame_) {
+                i++;
+                continue;
+            }
+
+            trees_[indexed.space].DestroyProxy(indexed.proxy);
+            indexed.proxy = kNullNode;
+            indexed_ids_[i] = indexed_ids_.back();
+            indexed_ids_.pop_back();
+        }
+    }
+
+    static SpatialSpace ToSpace(sol::optional<bool> isScreenSpace) {
+        return isScreenSpace.value_or(false) ? SpatialSpace::SCREEN_SPACE : SpatialSpace::WORLD_SPACE;
+    }
+
+    int FillLuaResults(sol::table results) {
+        const int count = static_cast<int>(lua_results_.size());
+        const int previousCount = static_cast<int>(results.size());
+
+        for (int i = 0; i < count; i++) {
+            results[i + 1] = lua_results_[i].GetId();
+        }
+
+        // Drop what is left of a longer earlier result so # stays correct.
+        for (int i = count + 1; i <= previousCount; i++) {
+            results[i] = sol::lua_nil;
+        }
+
+        lua_results_.clear();
+        return count;
+    }
+
+    int QueryPointLua(double x, double y, sol::table results, sol::optional<bool> isScreenSpace) {
+        QueryPoint(glm::vec2(x, y), ToSpace(isScreenSpace), lua_results_);
+        return FillLuaResults(results);
+    }
+
+    int QueryAABBLua(double minX, double minY, double maxX, double maxY, sol::table results, sol::optional<bool> isScreenSpace) {
+        QueryAABB(AABB(glm::vec2(minX, minY), glm::vec2(maxX, maxY)), ToSpace(isScreenSpace), lua_results_);
+        return FillLuaResults(results);
+    }
+
+    int QueryRadiusLua(double x, double y, double radius, sol::table results, sol::optional<bool> isScreenSpace) {
+        QueryRadius(glm::vec2(x, y), static_cast<float>(radius), ToSpace(isScreenSpace), lua_results_);
+        return FillLuaResults(results);
+    }
+
+    // Returns the id of the entity hit and the fraction, or nil.
+    std::tuple<sol::optional<int>, sol::optional<float>> RaycastLua(double fromX, double fromY, double toX, double toY, sol::optional<bool> isScreenSpace) {
+        Entity hit(-1, nullptr);
+        float fraction;
+
+        if (!Raycast(glm::vec2(fromX, fromY), glm::vec2(toX, toY), ToSpace(isScreenSpace), hit, fraction)) {
+            return {sol::nullopt, sol::nullopt};
+        }
+        return {hit.GetId(), fraction};
+    }
+
+    // Turns an id from a query back into an entity. Ids that are no longer
+    // indexed return nil.
+    sol::optional<Entity> GetIndexedEntityLua(int id) {
+        if (id < 0 || id >= static_cast<int>(indexed_.size()) || indexed_[id].proxy == kNullNode) {
+            return sol::nullopt;
+        }
+        return indexed_[id].entity;
+    }
+
+   public:
+    SpatialIndexSystem() : trees_(), indexed_(), indexed_ids_(), frame_(0), lua_results_() {
+        RequireComponent<TransformComponent>();
+        RequireComponent<BoxColliderComponent>();
+    }
+
+    ~SpatialIndexSystem() = default;
+
+    void Update() {
+        frame_++;
+
+        for (auto entity : GetEntities()) {
+            const int id = entity.GetId();
+            const auto& transform = entity.GetComponent<TransformComponent>();
+            const auto& collider = entity.GetComponent<BoxColliderComponent>();
+            const AABB bounds = CollisionSystem::GetColliderBounds(transform, collider);
+            const SpatialSpace space = GetSpace(entity);
+
+            if (id >= static_cast<int>(indexed_.size())) {
+                indexed_.resize(id + 1, {Entity(-1, nullptr), AABB(), SpatialSpace::WORLD_SPACE, kNullNode, 0});
+            }
+
+            auto& indexed = indexed_[id];
+
+            if (indexed.proxy == kNullNode) {
+                indexed.proxy = trees_[space].CreateProxy(bounds, id);
+                indexed_ids_.push_back(id);
+            } else if (indexed.space != space) {
+                trees_[indexed.space].DestroyProxy(indexed.proxy);
+                indexed.proxy = trees_[space].CreateProxy(bounds, id);
+            } else {
+                trees_[space].MoveProxy(indexed.proxy, bounds);
+            }
+
+            indexed.entity = entity;
+            indexed.bounds = bounds;
+            indexed.space = space;
+            indexed.lastSeenFrame = frame_;
+        }
+
+        RemoveUnseen();
+    }
+
+    // The queries append to results and test the exact collider bounds.
+
+    void QueryPoint(glm::vec2 point, SpatialSpace space, std::vector<Entity>& results) const {
+        trees_[space].QueryPoint(point, [&](int proxy) {
+            const auto& indexed = GetIndexed(space, proxy);
+            if (indexed.bounds.Contains(point)) {
+                results.push_back(indexed.entity);
+            }
+            return true;
+        });
+    }
+
+    void QueryAABB(const AABB& aabb, SpatialSpace space, std::vector<Entity>& results) const {
+        trees_[space].Query(aabb, [&](int proxy) {
+            const auto& indexed = GetIndexed(space, proxy);
+            if (indexed.bounds.Overlaps(aabb)) {
+                results.push_back(indexed.entity);
+            }
+            return true;
+        });
+    }
+
+    void QueryRadius(glm::vec2 center, float radius, SpatialSpace space, std::vector<Entity>& results) const {
+        const AABB aabb(center - glm::vec2(radius), center + glm::vec2(radius));
+
+        trees_[space].Query(aabb, [&](int proxy) {
+            const auto& indexed = GetIndexed(space, proxy);
+            const glm::vec2 closest = glm::clamp(center, indexed.bounds.min, indexed.bounds.max);
+            const glm::vec2 delta = closest - center;
+            if (glm::dot(delta, delta) <= radius * radius) {
+                results.push_back(indexed.entity);
+            }
+            return true;
+        });
+    }
+
+    // Finds the first collider hit by the segment from -> to. On a hit, fraction
+    // is how far along the segment it was hit.
+    bool Raycast(glm::vec2 from, glm::vec2 to, SpatialSpace space, Entity& hit, float& fraction) const {
+        int hitId = -1;
+        fraction = 1.0f;
+
+        trees_[space].Raycast(from, to, [&](int proxy, float maxFraction) {
+            const auto& indexed = GetIndexed(space, proxy);
+            float proxyFraction;
+            if (indexed.bounds.Raycast(from, to, proxyFraction) && proxyFraction <= maxFraction) {
+                hitId = indexed.entity.GetId();
+                fraction = proxyFraction;
+                return proxyFraction;
+            }
+            return maxFraction;
+        });
+
+        if (hitId == -1) {
+            return false;
+        }
+
+        hit = indexed_[hitId].entity;
+        return true;
+    }
+
+    // Lua queries fill a table the script owns with entity ids and return the
+    // count, so repeated queries do not create tables or entity objects. Pass
+    // true as the last argument to query the screen space index.
+    void CreateLuaBindings(sol::state& lua) {
+        lua.set_function("query_point", &SpatialIndexSystem::QueryPointLua, this);
+        lua.set_function("query_aabb", &SpatialIndexSystem::QueryAABBLua, this);
+        lua.set_function("query_radius", &SpatialIndexSystem::QueryRadiusLua, this);
+        lua.set_function("raycast", &SpatialIndexSystem::RaycastLua, this);
+        lua.set_function("get_indexed_entity", &SpatialIndexSystem::GetIndexedEntityLua, this);
+    }
+};
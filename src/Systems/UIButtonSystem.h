@@ -9,41 +9,46 @@
 #include "../Components/UIButtonComponent.h"
 #include "../ECS/ECS.h"
 #include "../Events/MouseInputEvent.h"
+#include "./SpatialIndexSystem.h"
 
 class UIButtonSystem : public System {
+   private:
+    const SpatialIndexSystem& spatial_index_;
+    std::vector<Entity> hits_;
+    EventSubscription mouse_input_subscription_;
+
    public:
-    UIButtonSystem() {
+    UIButtonSystem(const SpatialIndexSystem& spatialIndex) : spatial_index_(spatialIndex), hits_(), mouse_input_subscription_() {
         RequireComponent<UIButtonComponent>();
     }
 
     ~UIButtonSystem() = default;
 
     void SubscribeToEvents(std::unique_ptr<EventBus>& eventBus) {
-        eventBus->SubscribeEvent<UIButtonSystem, MouseInputEvent>(this, &UIButtonSystem::OnMouseInput);
+        mouse_input_subscription_ = eventBus->SubscribeEvent<UIButtonSystem, MouseInputEvent>(this, &UIButtonSystem::OnMouseInput);
     }
 
-    void OnMouseInput(MouseInputEvent& event) {
+    void OnMouseInput(const MouseInputEvent& event) {
         if (event.event.type != SDL_MOUSEBUTTONDOWN || event.event.button != 1) {
             return;
         }
 
-        for (auto entity : GetEntities()) {
-            auto button = entity.GetComponent<UIButtonComponent>();
-            if (button.clickFunction == sol::lua_nil || !entity.HasComponent<BoxColliderComponent>() || !entity.HasComponent<TransformComponent>()) {
+        // Buttons are hit tested against the mouse position in both indexes,
+        // the same way the raw transform positions used to be.
+        const glm::vec2 mouse(event.event.x, event.event.y);
+        hits_.clear();
+        spatial_index_.QueryPoint(mouse, SpatialSpace::SCREEN_SPACE, hits_);
+        spatial_index_.QueryPoint(mouse, SpatialSpace::WORLD_SPACE, hits_);
+
+        for (auto entity : hits_) {
+            if (!entity.HasComponent<UIButtonComponent>()) {
                 continue;
             }
 
-            auto boxCollider = entity.GetComponent<BoxColliderComponent>();
-            auto transform = entity.GetComponent<TransformComponent>();
-            int mouseX = event.event.x;
-            int mouseY = event.event.y;
-            bool isClick = transform.position.x <= mouseX &&
-                           (transform.position.x + boxCollider.width * transform.scale.x) >= mouseX &&
-                           transform.position.y <= mouseY &&
-                           (transform.position.y + boxCollider.height * transform.scale.y) >= mouseY;
-            if (isClick) {
+            auto button = entity.GetComponent<UIButtonComponent>();
+            if (button.clickFunction != sol::lua_nil) {
                 button.clickFunction(button.buttonTable, entity);
             }
         }
     }
-};
\ No newline at end of file
+};